@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# -*- Mode:Python; -*-
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+"""Reader for the binary traces of PointToPointHelper::SetBinaryTrace.
+
+Usage:
+  p2p-binary-trace.py FILE.btr            per-event and per-protocol summary
+  p2p-binary-trace.py --csv FILE.btr      one CSV line per record
+  p2p-binary-trace.py --ascii FILE.btr    lines as written by SetAsciiSummary
+
+As a module, read_records() yields tuples without extra dependencies and
+load() returns a numpy structured array of the whole file.
+"""
+
+import struct
+import sys
+
+MAGIC = b"P2PBTRC\0"
+HEADER = struct.Struct("<8sII")
+RECORD = struct.Struct("<qQIIIHHBBH")
+FIELDS = ("time_ns", "uid", "node", "device", "wire_size", "original_size",
+          "protocol", "event", "compressed")
+
+
+def _check_header(data):
+    magic, version, record_size = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError("not a point-to-point binary trace")
+    if version != 1 or record_size != RECORD.size:
+        raise ValueError("unsupported trace version %d, record size %d" % (version, record_size))
+
+
+def read_records(filename):
+    """Yield one tuple per record, with the fields named in FIELDS."""
+    with open(filename, "rb") as f:
+        _check_header(f.read(HEADER.size))
+        while True:
+            # Read many records at a time, the files are large
+            chunk = f.read(RECORD.size * 65536)
+            if not chunk:
+                break
+            usable = len(chunk) - len(chunk) % RECORD.size
+            for (time_ns, uid, node, wire_size, original_size, device,
+                 protocol, event, flags, _) in RECORD.iter_unpack(chunk[:usable]):
+                yield (time_ns, uid, node, device, wire_size, original_size,
+                       protocol, chr(event), bool(flags & 1))
+
+
+def load(filename):
+    """Return the records of a file as a numpy structured array."""
+    import numpy
+    dtype = numpy.dtype([("time_ns", "<i8"), ("uid", "<u8"), ("node", "<u4"),
+                         ("wire_size", "<u4"), ("original_size", "<u4"),
+                         ("device", "<u2"), ("protocol", "<u2"), ("event", "u1"),
+                         ("flags", "u1"), ("reserved", "<u2")])
+    assert dtype.itemsize == RECORD.size
+    with open(filename, "rb") as f:
+        _check_header(f.read(HEADER.size))
+        return numpy.fromfile(f, dtype=dtype)
+
+
+def summary(filename):
+    events = {}
+    protocols = {}
+    for (_, _, _, _, wire_size, original_size, protocol, event, compressed) in read_records(filename):
+        count, wire = events.get(event, (0, 0))
+        events[event] = (count + 1, wire + wire_size)
+        if event == "-":
+            count, wire, original = protocols.get(protocol, (0, 0, 0))
+            protocols[protocol] = (count + 1, wire + wire_size, original + original_size)
+    for event in sorted(events):
+        count, wire = events[event]
+        print("%s %d packets, %d bytes" % (event, count, wire))
+    print("dequeued per protocol:")
+    for protocol in sorted(protocols):
+        count, wire, original = protocols[protocol]
+        print("  0x%04x %d packets, %d wire bytes, %d original bytes, ratio %.3f"
+              % (protocol, count, wire, original, float(original) / wire if wire else 0))
+
+
+def main(argv):
+    if len(argv) == 3 and argv[1] in ("--csv", "--ascii"):
+        if argv[1] == "--csv":
+            print(",".join(FIELDS))
+            for record in read_records(argv[2]):
+                print("%d,%d,%d,%d,%d,%d,%d,%s,%d" % record)
+        else:
+            for (time_ns, uid, node, device, wire_size, original_size, protocol,
+                 event, compressed) in read_records(argv[2]):
+                print("%s %.9f /NodeList/%d/DeviceList/%d uid=%d protocol=0x%04x size=%d%s"
+                      % (event, time_ns / 1e9, node, device, uid, protocol, wire_size,
+                         " original=%d" % original_size if compressed else ""))
+    elif len(argv) == 2:
+        summary(argv[1])
+    else:
+        sys.stderr.write(__doc__)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
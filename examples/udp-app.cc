@@ -23,14 +23,16 @@
 //       receiver node R.
 
 #include <fstream>
+#include <sstream>
 #include "ns3/core-module.h"
 #include "ns3/csma-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/project1-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/internet-module.h"
-#include <nlohmann/json.hpp>
-#include <iomanip>
+#include "ns3/point-to-point-compression-config.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/compression-flow-monitor-helper.h"
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -41,7 +43,6 @@ extern "C"{
 
 
 using namespace ns3;
-using json = nlohmann::json;
 
 NS_LOG_COMPONENT_DEFINE ("UdpClientServerExample");
 
@@ -58,7 +59,16 @@ main (int argc, char *argv[])
 
   bool useV6 = false;
   bool compressionEnabled = false;
+  bool flowMonitor = false;
+  bool dualViewPcap = false;
+  bool asyncTrace = false;
+  bool binaryTrace = false;
+  bool asciiSummary = false;
   uint16_t maxBandwidth = 0;
+  uint32_t flows = 0;
+  std::string flowRate = "100kbps";
+  std::string replay = "";
+  double replayTimeScale = 1.0;
   Address udpServerInterfaces;
   Address p2pInterfaces;
 
@@ -67,20 +77,31 @@ main (int argc, char *argv[])
   cmd.AddValue ("useIpv6", "Use Ipv6", useV6);
   cmd.AddValue ("maxBandwidth", "Maximum bandwidth", maxBandwidth);
   cmd.AddValue ("compressionEnabled", "Enable compression", compressionEnabled);
+  cmd.AddValue ("flowMonitor", "Write per-flow statistics to udp-app.flowmon", flowMonitor);
+  cmd.AddValue ("dualViewPcap", "Also capture the uncompressed packets of the point-to-point link", dualViewPcap);
+  cmd.AddValue ("asyncTrace", "Write the point-to-point pcap files on a background thread", asyncTrace);
+  cmd.AddValue ("binaryTrace", "Write compact binary event traces of the point-to-point link", binaryTrace);
+  cmd.AddValue ("asciiSummary", "Write short ascii traces of the point-to-point link, without packet printing", asciiSummary);
+  cmd.AddValue ("flows", "Also send this many flows from one MultiFlowClient", flows);
+  cmd.AddValue ("flowRate", "Rate of each of the flows", flowRate);
+  cmd.AddValue ("replay", "Also replay the UDP datagrams of this pcap file, e.g. Compression.pcap", replay);
+  cmd.AddValue ("replayTimeScale", "Factor applied to the gaps of the replayed capture", replayTimeScale);
   cmd.Parse (argc, argv);
   printf("Specified maximum bandwidth: %d\n", maxBandwidth);
 
-// Read config file; take inputstream from the file and put it all in json j
-  std::ifstream jsonIn("config.json");
-  json j;
-  jsonIn >> j;
-// Print the pretty json to the terminal
-  std::cout << std::setw(4) << j << std::endl;
-  std::string protocol = "";
-
-// Get the string value from protocolsToCompress and print it
-  protocol = j["protocolsToCompress"].get<std::string>();
-  std::cout << protocol << "\n";
+// The compression config is parsed once per process and shared with the
+// devices.  Use --CompressionConfigPath=<file> or --CompressionConfigJson=<json>
+// to point it somewhere other than ./config.json.
+  if (compressionEnabled)
+    {
+      const CompressionConfig &config = CompressionConfig::Get ();
+      std::cout << "Compression config from " << config.GetOrigin () << ", protocols:";
+      for (uint16_t protocol : config.GetProtocols ())
+        {
+          std::cout << " 0x" << std::hex << protocol << std::dec;
+        }
+      std::cout << "\n";
+    }
 
 // Set data rate for point to point
   std::string dataRate (std::to_string(maxBandwidth));
@@ -187,6 +208,32 @@ main (int argc, char *argv[])
   // p2pClient.Start (Seconds (2.0));
   // p2pClient.Stop (Seconds (300.0));
 
+  if (flows > 0)
+    {
+      std::ostringstream server;
+      if (useV6)
+        {
+          server << Ipv6Address::ConvertFrom (udpServerInterfaces);
+        }
+      else
+        {
+          server << Ipv4Address::ConvertFrom (udpServerInterfaces);
+        }
+      std::ostringstream spec;
+      spec << "[{\"address\": \"" << server.str () << "\", \"port\": " << port
+           << ", \"size\": " << MaxPacketSize << ", \"rate\": \"" << flowRate
+           << "\", \"packets\": " << maxPacketCount << ", \"flows\": " << flows << "}]";
+      MultiFlowClientHelper multiFlowClient (spec.str ());
+      multiFlowClient.Install (udpNodes.Get (0));
+    }
+
+  if (!replay.empty ())
+    {
+      PcapReplayClientHelper replayClient (udpServerInterfaces, port, replay);
+      replayClient.SetAttribute ("TimeScale", DoubleValue (replayTimeScale));
+      replayClient.Install (udpNodes.Get (0));
+    }
+
 // #if 0
 // set fill for packet data
 // #endif
@@ -194,16 +241,42 @@ main (int argc, char *argv[])
   // Init routers (PointToPoint devices)
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
-  AsciiTraceHelper ascii;;
-  csma.EnableAsciiAll (ascii.CreateFileStream ("udp-app-l.tr"));
+  // The full ascii trace prints packets; leave it out when only summaries
+  // are asked for
+  if (!asciiSummary)
+    {
+      AsciiTraceHelper ascii;
+      csma.EnableAsciiAll (ascii.CreateFileStream ("udp-app-l.tr"));
+    }
   csma.EnablePcapAll ("udp-app-l", false);
+  pointToPoint.SetDualViewPcap (dualViewPcap);
+  pointToPoint.SetAsyncTraceWriter (asyncTrace);
   pointToPoint.EnablePcapAll ("udp-p2p-l", false);
+  if (binaryTrace || asciiSummary)
+    {
+      pointToPoint.SetBinaryTrace (binaryTrace);
+      pointToPoint.SetAsciiSummary (asciiSummary);
+      pointToPoint.EnableAsciiAll ("udp-p2p-l");
+    }
+
+// Per-flow statistics, including how well each flow compressed
+  FlowMonitorHelper flowmon;
+  CompressionFlowMonitorHelper compressionFlowmon;
+  if (flowMonitor)
+    {
+      flowmon.InstallAll ();
+      compressionFlowmon.Install (flowmon, p2pDevices);
+    }
 
 //
 // Now, do the actual simulation.
 //
   NS_LOG_INFO ("Run Simulation.");
   Simulator::Run ();
+  if (flowMonitor)
+    {
+      compressionFlowmon.SerializeToXmlFile (flowmon, "udp-app.flowmon", false, true);
+    }
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <fstream>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/compression-flow-probe.h"
+#include "compression-flow-monitor-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressionFlowMonitorHelper");
+
+CompressionFlowMonitorHelper::CompressionFlowMonitorHelper ()
+{
+}
+
+void
+CompressionFlowMonitorHelper::Install (FlowMonitorHelper &flowmon, NetDeviceContainer devices)
+{
+  Ptr<FlowMonitor> monitor = flowmon.GetMonitor ();
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Ptr<PointToPointNetDevice> device = (*i)->GetObject<PointToPointNetDevice> ();
+      if (device == 0)
+        {
+          NS_LOG_INFO ("Device " << *i << " is not a PointToPointNetDevice, skipping");
+          continue;
+        }
+      // The probe registers itself with the monitor, which keeps it alive
+      Create<CompressionFlowProbe> (monitor, classifier, device);
+    }
+}
+
+void
+CompressionFlowMonitorHelper::SerializeToXmlStream (FlowMonitorHelper &flowmon, std::ostream &os, uint16_t indent,
+                                                    bool enableHistograms, bool enableProbes)
+{
+  std::string xml = flowmon.SerializeToXmlString (indent, enableHistograms, enableProbes);
+  std::string::size_type end = xml.rfind ("</FlowMonitor>");
+  NS_ASSERT (end != std::string::npos);
+  // Back up to the start of the closing tag's line to keep its indentation
+  std::string::size_type lineStart = xml.rfind ('\n', end);
+  lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+  os << xml.substr (0, lineStart);
+
+#define INDENT(level) for (int __xpto = 0; __xpto < level; __xpto++) os << ' ';
+  indent += 2;
+  INDENT (indent); os << "<CompressionProbes>\n";
+  const FlowMonitor::FlowProbeContainer &probes = flowmon.GetMonitor ()->GetAllProbes ();
+  for (uint32_t i = 0; i < probes.size (); ++i)
+    {
+      Ptr<CompressionFlowProbe> probe = DynamicCast<CompressionFlowProbe> (probes[i]);
+      if (probe)
+        {
+          probe->SerializeCompressionToXmlStream (os, indent + 2, i);
+        }
+    }
+  INDENT (indent); os << "</CompressionProbes>\n";
+#undef INDENT
+
+  os << xml.substr (lineStart);
+}
+
+void
+CompressionFlowMonitorHelper::SerializeToXmlFile (FlowMonitorHelper &flowmon, std::string fileName,
+                                                  bool enableHistograms, bool enableProbes)
+{
+  std::ofstream os (fileName.c_str (), std::ios::out|std::ios::binary);
+  os << "<?xml version=\"1.0\" ?>\n";
+  SerializeToXmlStream (flowmon, os, 0, enableHistograms, enableProbes);
+  os.close ();
+}
+
+} // namespace ns3
@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef COMPRESSION_FLOW_MONITOR_HELPER_H
+#define COMPRESSION_FLOW_MONITOR_HELPER_H
+
+#include <ostream>
+#include <string>
+#include "ns3/net-device-container.h"
+#include "ns3/flow-monitor-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup udpapp
+ * \brief Add per-flow compression accounting to a FlowMonitor
+ *
+ * \code
+ *   FlowMonitorHelper flowmon;
+ *   flowmon.InstallAll ();
+ *   CompressionFlowMonitorHelper compressionFlowmon;
+ *   compressionFlowmon.Install (flowmon, p2pDevices);
+ *   ...
+ *   Simulator::Run ();
+ *   compressionFlowmon.SerializeToXmlFile (flowmon, "flows.xml", false, true);
+ * \endcode
+ */
+class CompressionFlowMonitorHelper
+{
+public:
+  CompressionFlowMonitorHelper ();
+
+  /**
+   * \brief Attach a CompressionFlowProbe to each PointToPointNetDevice
+   * \param flowmon a FlowMonitorHelper on which Install* was already called
+   * \param devices the devices on the compressing side of the links
+   */
+  void Install (FlowMonitorHelper &flowmon, NetDeviceContainer devices);
+
+  /**
+   * Same as FlowMonitorHelper::SerializeToXmlStream, with a
+   * \c CompressionProbes element holding the per-flow compression
+   * statistics appended inside the \c FlowMonitor element.
+   *
+   * \param flowmon the FlowMonitorHelper passed to Install
+   * \param os the output stream
+   * \param indent number of spaces to use as base indentation level
+   * \param enableHistograms if true, include also the histograms in the output
+   * \param enableProbes if true, include also the per-probe/flow pair statistics in the output
+   */
+  void SerializeToXmlStream (FlowMonitorHelper &flowmon, std::ostream &os, uint16_t indent,
+                             bool enableHistograms, bool enableProbes);
+
+  /**
+   * Same as SerializeToXmlStream, but writes to a file instead
+   * \param flowmon the FlowMonitorHelper passed to Install
+   * \param fileName name or path of the output file that will be created
+   * \param enableHistograms if true, include also the histograms in the output
+   * \param enableProbes if true, include also the per-probe/flow pair statistics in the output
+   */
+  void SerializeToXmlFile (FlowMonitorHelper &flowmon, std::string fileName,
+                           bool enableHistograms, bool enableProbes);
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSION_FLOW_MONITOR_HELPER_H */
@@ -24,10 +24,14 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/point-to-point-remote-channel.h"
+#include "ns3/point-to-point-trace-writer.h"
+#include "ns3/point-to-point-compression-header.h"
+#include "ns3/ppp-header.h"
 #include "ns3/queue.h"
 #include "ns3/config.h"
 #include "ns3/packet.h"
 #include "ns3/names.h"
+#include "ns3/boolean.h"
 #include "ns3/mpi-interface.h"
 #include "ns3/mpi-receiver.h"
 
@@ -35,6 +39,7 @@
 #include "point-to-point-helper.h"
 
 #include <assert.h>
+#include <iomanip>
 extern "C"{
 #include "zlib.h"
 }
@@ -43,7 +48,181 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PointToPointHelper");
 
+namespace {
+
+/// The files of a dual view capture of one device
+struct DualViewCapture : public SimpleRefCount<DualViewCapture>
+{
+  Ptr<PcapFileWrapper> wire;       //!< Frames on the wire
+  Ptr<PcapFileWrapper> logical;    //!< Uncompressed packets
+  Ptr<OutputStreamWrapper> index;  //!< Links the records of both files
+  uint32_t wireRecords;            //!< Records written to wire
+  uint32_t logicalRecords;         //!< Records written to logical
+};
+
+void
+DualViewWireSink (Ptr<DualViewCapture> capture, Ptr<const Packet> p)
+{
+  capture->wire->Write (Simulator::Now (), p);
+  *capture->index->GetStream () << "wire," << ++capture->wireRecords << ","
+                                << Simulator::Now ().GetNanoSeconds () << ","
+                                << p->GetUid () << "," << p->GetUid () << ","
+                                << p->GetSize () << "\n";
+}
+
+void
+DualViewLogicalSink (Ptr<DualViewCapture> capture, Ptr<const Packet> p, uint64_t wireUid)
+{
+  capture->logical->Write (Simulator::Now (), p);
+  *capture->index->GetStream () << "logical," << ++capture->logicalRecords << ","
+                                << Simulator::Now ().GetNanoSeconds () << ","
+                                << p->GetUid () << "," << wireUid << ","
+                                << p->GetSize () << "\n";
+}
+
+/// Where the link trace records of one device go
+struct LinkTraceTarget : public SimpleRefCount<LinkTraceTarget>
+{
+  Ptr<OutputStreamWrapper> stream;         //!< Stream to write to, or
+  Ptr<PointToPointTraceWriter> writer;     //!< asynchronous writer to write binary records to
+  bool binary;                             //!< Binary records rather than summary lines
+  uint32_t node;                           //!< Node id of the device
+  uint16_t device;                         //!< Interface index of the device
+};
+
+/// Size of a binary trace record, see PointToPointHelper::SetBinaryTrace
+const uint32_t BINARY_TRACE_RECORD_SIZE = 36;
+
+/**
+ * \param buffer where to write
+ * \param value the value to write little-endian
+ * \param bytes the size of value in bytes
+ */
+void
+WriteLittleEndian (uint8_t *buffer, uint64_t value, uint32_t bytes)
+{
+  for (uint32_t i = 0; i < bytes; i++)
+    {
+      buffer[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+void
+WriteBinaryTraceData (Ptr<LinkTraceTarget> target, const uint8_t *data, uint32_t size)
+{
+  if (target->writer)
+    {
+      target->writer->Write (data, size);
+    }
+  else
+    {
+      target->stream->GetStream ()->write (reinterpret_cast<const char *> (data), size);
+    }
+}
+
+void
+WriteBinaryTraceHeader (Ptr<LinkTraceTarget> target)
+{
+  uint8_t header[16] = { 'P', '2', 'P', 'B', 'T', 'R', 'C', 0 };
+  WriteLittleEndian (header + 8, 1, 4);
+  WriteLittleEndian (header + 12, BINARY_TRACE_RECORD_SIZE, 4);
+  WriteBinaryTraceData (target, header, sizeof (header));
+}
+
+/**
+ * Write one record of a link trace.  Only the PPP and compression headers
+ * are read, so packet printing is not needed.
+ *
+ * \param target where to write
+ * \param event '+', '-', 'd' or 'r'
+ * \param p the frame
+ */
+void
+WriteLinkTraceRecord (Ptr<LinkTraceTarget> target, uint8_t event, Ptr<const Packet> p)
+{
+  uint32_t wireSize = p->GetSize ();
+  uint32_t originalSize = wireSize;
+  uint16_t protocol = 0;
+  bool compressed = false;
+  PppHeader ppp;
+  if (wireSize >= ppp.GetSerializedSize ())
+    {
+      p->PeekHeader (ppp);
+      protocol = ppp.GetProtocol ();
+      if (protocol == 0x4021)
+        {
+          // Compressed frame: the compression header has the original payload
+          Ptr<Packet> frame = p->Copy ();
+          frame->RemoveHeader (ppp);
+          CompressionHeader compression;
+          frame->PeekHeader (compression);
+          protocol = compression.GetProtocol ();
+          originalSize = ppp.GetSerializedSize () + compression.GetOriginalSize ();
+          compressed = true;
+        }
+    }
+
+  if (!target->binary)
+    {
+      std::ostream *os = target->stream->GetStream ();
+      *os << event << " " << std::fixed << std::setprecision (9) << Simulator::Now ().GetSeconds ()
+          << " /NodeList/" << target->node << "/DeviceList/" << target->device
+          << " uid=" << p->GetUid ()
+          << " protocol=0x" << std::hex << std::setw (4) << std::setfill ('0') << protocol
+          << std::dec << std::setfill (' ')
+          << " size=" << wireSize;
+      if (compressed)
+        {
+          *os << " original=" << originalSize;
+        }
+      *os << '\n';
+      return;
+    }
+
+  uint8_t record[BINARY_TRACE_RECORD_SIZE] = { 0 };
+  WriteLittleEndian (record, Simulator::Now ().GetNanoSeconds (), 8);
+  WriteLittleEndian (record + 8, p->GetUid (), 8);
+  WriteLittleEndian (record + 16, target->node, 4);
+  WriteLittleEndian (record + 20, wireSize, 4);
+  WriteLittleEndian (record + 24, originalSize, 4);
+  WriteLittleEndian (record + 28, target->device, 2);
+  WriteLittleEndian (record + 30, protocol, 2);
+  record[32] = event;
+  record[33] = compressed ? 1 : 0;
+  WriteBinaryTraceData (target, record, sizeof (record));
+}
+
+void
+LinkEnqueueSink (Ptr<LinkTraceTarget> target, Ptr<const Packet> p)
+{
+  WriteLinkTraceRecord (target, '+', p);
+}
+
+void
+LinkDequeueSink (Ptr<LinkTraceTarget> target, Ptr<const Packet> p)
+{
+  WriteLinkTraceRecord (target, '-', p);
+}
+
+void
+LinkDropSink (Ptr<LinkTraceTarget> target, Ptr<const Packet> p)
+{
+  WriteLinkTraceRecord (target, 'd', p);
+}
+
+void
+LinkReceiveSink (Ptr<LinkTraceTarget> target, Ptr<const Packet> p)
+{
+  WriteLinkTraceRecord (target, 'r', p);
+}
+
+} // anonymous namespace
+
 PointToPointHelper::PointToPointHelper ()
+  : m_dualViewPcap (false),
+    m_asyncTraceWriter (false),
+    m_binaryTrace (false),
+    m_asciiSummary (false)
 {
   m_queueFactory.SetTypeId ("ns3::DropTailQueue<Packet>");
   m_deviceFactory.SetTypeId ("ns3::PointToPointNetDevice");
@@ -73,6 +252,54 @@ PointToPointHelper::SetDeviceAttribute (std::string n1, const AttributeValue &v1
   m_deviceFactory.Set (n1, v1);
 }
 
+void
+PointToPointHelper::AddTxQueue (uint32_t weight, bool compress)
+{
+  NS_ABORT_MSG_IF (weight == 0, "A transmit queue needs a weight of at least 1");
+  m_txQueuePolicies.push_back (std::make_pair (weight, compress));
+}
+
+void
+PointToPointHelper::AddTxStage (PointToPointTxStage::Position position, std::string type,
+                                std::string n1, const AttributeValue &v1,
+                                std::string n2, const AttributeValue &v2,
+                                std::string n3, const AttributeValue &v3,
+                                std::string n4, const AttributeValue &v4)
+{
+  NS_ABORT_MSG_IF (position == PointToPointTxStage::ENQUEUE, "Nothing can run after ENQUEUE");
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  factory.Set (n1, v1);
+  factory.Set (n2, v2);
+  factory.Set (n3, v3);
+  factory.Set (n4, v4);
+  m_txStageFactories.push_back (std::make_pair (position, factory));
+}
+
+void
+PointToPointHelper::SetDualViewPcap (bool enable)
+{
+  m_dualViewPcap = enable;
+}
+
+void
+PointToPointHelper::SetAsyncTraceWriter (bool enable)
+{
+  m_asyncTraceWriter = enable;
+}
+
+void
+PointToPointHelper::SetBinaryTrace (bool enable)
+{
+  m_binaryTrace = enable;
+}
+
+void
+PointToPointHelper::SetAsciiSummary (bool enable)
+{
+  m_asciiSummary = enable;
+}
+
 void 
 PointToPointHelper::SetChannelAttribute (std::string n1, const AttributeValue &v1)
 {
@@ -107,9 +334,43 @@ PointToPointHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, b
       filename = pcapHelper.GetFilenameFromDevice (prefix, device);
     }
 
+  BooleanValue compression;
+  device->GetAttribute ("Compression", compression);
+  if (m_asyncTraceWriter && !(m_dualViewPcap && compression.Get ()))
+    {
+      Ptr<PointToPointTraceWriter> writer = CreateObject<PointToPointTraceWriter> ();
+      writer->Open (filename);
+      writer->WritePcapHeader (PcapHelper::DLT_PPP);
+      device->TraceConnectWithoutContext ("PromiscSniffer",
+                                          MakeCallback (&PointToPointTraceWriter::WritePcapPacket, writer));
+      return;
+    }
+
   Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, 
                                                      PcapHelper::DLT_PPP);
-  pcapHelper.HookDefaultSink<PointToPointNetDevice> (device, "PromiscSniffer", file);
+  if (!m_dualViewPcap || !compression.Get ())
+    {
+      pcapHelper.HookDefaultSink<PointToPointNetDevice> (device, "PromiscSniffer", file);
+      return;
+    }
+
+  std::string base = filename;
+  std::string::size_type dot = base.rfind (".pcap");
+  if (dot != std::string::npos)
+    {
+      base = base.substr (0, dot);
+    }
+  Ptr<DualViewCapture> capture = Create<DualViewCapture> ();
+  capture->wire = file;
+  capture->logical = pcapHelper.CreateFile (base + "-logical.pcap", std::ios::out,
+                                            PcapHelper::DLT_RAW);
+  AsciiTraceHelper asciiTraceHelper;
+  capture->index = asciiTraceHelper.CreateFileStream (base + "-index.csv");
+  *capture->index->GetStream () << "view,record,time_ns,uid,wire_uid,bytes\n";
+  capture->wireRecords = 0;
+  capture->logicalRecords = 0;
+  device->TraceConnectWithoutContext ("PromiscSniffer", MakeBoundCallback (&DualViewWireSink, capture));
+  device->TraceConnectWithoutContext ("LogicalSniffer", MakeBoundCallback (&DualViewLogicalSink, capture));
 }
 
 Ptr<Packet>
@@ -208,6 +469,12 @@ PointToPointHelper::EnableAsciiInternal (
       return;
     }
 
+  if (m_binaryTrace || m_asciiSummary)
+    {
+      EnableLinkTraceInternal (stream, prefix, device, explicitFilename);
+      return;
+    }
+
   //
   // Our default trace sinks are going to use packet printing, so we have to 
   // make sure that is turned on.
@@ -239,7 +506,17 @@ PointToPointHelper::EnableAsciiInternal (
           filename = asciiTraceHelper.GetFilenameFromDevice (prefix, device);
         }
 
-      Ptr<OutputStreamWrapper> theStream = asciiTraceHelper.CreateFileStream (filename);
+      Ptr<OutputStreamWrapper> theStream;
+      if (m_asyncTraceWriter)
+        {
+          Ptr<PointToPointTraceWriter> writer = CreateObject<PointToPointTraceWriter> ();
+          writer->Open (filename);
+          theStream = writer->GetStream ();
+        }
+      else
+        {
+          theStream = asciiTraceHelper.CreateFileStream (filename);
+        }
 
       //
       // The MacRx trace source provides our "r" event.
@@ -297,6 +574,77 @@ PointToPointHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void
+PointToPointHelper::EnableLinkTraceInternal (Ptr<OutputStreamWrapper> stream,
+                                             std::string prefix,
+                                             Ptr<PointToPointNetDevice> device,
+                                             bool explicitFilename)
+{
+  Ptr<LinkTraceTarget> target = Create<LinkTraceTarget> ();
+  target->binary = m_binaryTrace;
+  target->node = device->GetNode ()->GetId ();
+  target->device = device->GetIfIndex ();
+
+  if (stream == 0)
+    {
+      AsciiTraceHelper asciiTraceHelper;
+      std::string filename;
+      if (explicitFilename)
+        {
+          filename = prefix;
+        }
+      else
+        {
+          filename = asciiTraceHelper.GetFilenameFromDevice (prefix, device);
+          if (target->binary)
+            {
+              // prefix-node-device.tr -> prefix-node-device.btr
+              filename = filename.substr (0, filename.rfind (".tr")) + ".btr";
+            }
+        }
+      if (m_asyncTraceWriter)
+        {
+          Ptr<PointToPointTraceWriter> writer = CreateObject<PointToPointTraceWriter> ();
+          writer->Open (filename);
+          if (target->binary)
+            {
+              target->writer = writer;
+            }
+          else
+            {
+              target->stream = writer->GetStream ();
+            }
+        }
+      else
+        {
+          target->stream = asciiTraceHelper.CreateFileStream (filename, std::ios::out | std::ios::binary);
+        }
+      if (target->binary)
+        {
+          WriteBinaryTraceHeader (target);
+        }
+    }
+  else
+    {
+      target->stream = stream;
+      // Several devices may share one stream, which needs one header
+      if (target->binary && m_binaryStreams.insert (stream).second)
+        {
+          WriteBinaryTraceHeader (target);
+        }
+    }
+
+  device->TraceConnectWithoutContext ("MacRx", MakeBoundCallback (&LinkReceiveSink, target));
+  device->TraceConnectWithoutContext ("PhyRxDrop", MakeBoundCallback (&LinkDropSink, target));
+  for (uint32_t i = 0; i < device->GetNTxQueues (); i++)
+    {
+      Ptr<Queue<Packet> > queue = device->GetTxQueue (i);
+      queue->TraceConnectWithoutContext ("Enqueue", MakeBoundCallback (&LinkEnqueueSink, target));
+      queue->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&LinkDequeueSink, target));
+      queue->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&LinkDropSink, target));
+    }
+}
+
 NetDeviceContainer 
 PointToPointHelper::Install (NodeContainer c)
 {
@@ -312,13 +660,28 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
   Ptr<PointToPointNetDevice> devA = m_deviceFactory.Create<PointToPointNetDevice> ();
   devA->SetAddress (Mac48Address::Allocate ());
   a->AddDevice (devA);
-  Ptr<Queue<Packet> > queueA = m_queueFactory.Create<Queue<Packet> > ();
-  devA->SetQueue (queueA);
   Ptr<PointToPointNetDevice> devB = m_deviceFactory.Create<PointToPointNetDevice> ();
   devB->SetAddress (Mac48Address::Allocate ());
   b->AddDevice (devB);
-  Ptr<Queue<Packet> > queueB = m_queueFactory.Create<Queue<Packet> > ();
-  devB->SetQueue (queueB);
+  if (m_txQueuePolicies.empty ())
+    {
+      Ptr<Queue<Packet> > queueA = m_queueFactory.Create<Queue<Packet> > ();
+      devA->SetQueue (queueA);
+      Ptr<Queue<Packet> > queueB = m_queueFactory.Create<Queue<Packet> > ();
+      devB->SetQueue (queueB);
+    }
+  for (std::vector<std::pair<uint32_t, bool> >::const_iterator i = m_txQueuePolicies.begin ();
+       i != m_txQueuePolicies.end (); ++i)
+    {
+      devA->AddTxQueue (m_queueFactory.Create<Queue<Packet> > (), i->first, i->second);
+      devB->AddTxQueue (m_queueFactory.Create<Queue<Packet> > (), i->first, i->second);
+    }
+  for (std::vector<std::pair<PointToPointTxStage::Position, ObjectFactory> >::const_iterator i = m_txStageFactories.begin ();
+       i != m_txStageFactories.end (); ++i)
+    {
+      devA->InsertTxStage (i->first, i->second.Create<PointToPointTxStage> ());
+      devB->InsertTxStage (i->first, i->second.Create<PointToPointTxStage> ());
+    }
   // If MPI is enabled, we need to see if both nodes have the same system id 
   // (rank), and the rank is the same as this instance.  If both are true, 
   //use a normal p2p channel, otherwise use a remote channel
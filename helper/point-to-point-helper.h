@@ -27,6 +27,10 @@
 #include "ns3/node-container.h"
 
 #include "ns3/trace-helper.h"
+#include "ns3/point-to-point-tx-stage.h"
+#include <set>
+#include <utility>
+#include <vector>
 
 #include <assert.h>
 extern "C"{
@@ -37,6 +41,7 @@ namespace ns3 {
 
 class NetDevice;
 class Node;
+class PointToPointNetDevice;
 
 /**
  * \brief Build a set of PointToPointNetDevice objects
@@ -80,6 +85,18 @@ public:
                  std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
                  std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue ());
 
+  /**
+   * Give each PointToPointNetDevice created by the helper one more transmit
+   * queue, of the type set with SetQueue.  Queues are added in decreasing
+   * priority; without any call each device gets a single queue.
+   *
+   * \param weight packets served per round with the WeightedRoundRobin scheduler
+   * \param compress false to never compress packets in this queue
+   *
+   * \see PointToPointNetDevice::AddTxQueue
+   */
+  void AddTxQueue (uint32_t weight = 1, bool compress = true);
+
   /**
    * Set an attribute value to be propagated to each NetDevice created by the
    * helper.
@@ -104,6 +121,115 @@ public:
    */
   void SetChannelAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Capture compressing devices in two views when pcap is enabled.
+   *
+   * Besides the usual \c prefix-node-device.pcap of the frames on the wire,
+   * each device with the Compression attribute set gets
+   * \c prefix-node-device-logical.pcap, holding the uncompressed IP packet
+   * of every frame it sends or receives, and \c prefix-node-device-index.csv,
+   * with one line per record of either file:
+   *
+   * \code
+   *   view,record,time_ns,uid,wire_uid,bytes
+   * \endcode
+   *
+   * where \c record counts from 1 within the view's file.  A logical record
+   * and the wire record with the same \c wire_uid are the same packet, so
+   * the two byte counts give its compression ratio and the two times its
+   * delay through the device.
+   *
+   * \param enable true to write the logical view and index
+   */
+  void SetDualViewPcap (bool enable);
+
+  /**
+   * Write the pcap and ascii trace files the helper creates through a
+   * PointToPointTraceWriter, so that file I/O happens on a background thread.
+   * Its buffer size and full-buffer policy are the PointToPointTraceWriter
+   * attributes, e.g. ns3::PointToPointTraceWriter::DropWhenFull.
+   *
+   * This does not apply to ascii streams passed in by the caller, nor to the
+   * logical view files of SetDualViewPcap.
+   *
+   * \param enable true to write trace files asynchronously
+   */
+  void SetAsyncTraceWriter (bool enable);
+
+  /**
+   * Make EnableAscii write compact binary records instead of text lines.
+   *
+   * Files get the extension \c .btr instead of \c .tr, and packet printing
+   * is not needed.  A file starts with a 16 byte header: the magic
+   * \c "P2PBTRC\0", then the format version (1) and the record size (36)
+   * as little-endian uint32.  Each record is 36 bytes, little-endian:
+   *
+   * \code
+   *   offset type    field
+   *        0 int64   time_ns
+   *        8 uint64  uid
+   *       16 uint32  node
+   *       20 uint32  wire_size      frame bytes, as traced
+   *       24 uint32  original_size  frame bytes before compression
+   *       28 uint16  device
+   *       30 uint16  protocol       PPP protocol of the (uncompressed) payload
+   *       32 uint8   event          '+', '-', 'd' or 'r', as in ascii traces
+   *       33 uint8   flags          bit 0: the frame is compressed
+   *       34 uint16  reserved
+   * \endcode
+   *
+   * Events come from every transmit queue of the device, MacRx and
+   * PhyRxDrop.  examples/p2p-binary-trace.py reads, summarizes and converts
+   * these files.
+   *
+   * \param enable true to write binary traces
+   */
+  void SetBinaryTrace (bool enable);
+
+  /**
+   * Make EnableAscii write one short text line per event, without
+   * Packet::EnablePrinting.
+   *
+   * The full ascii trace prints every header of a packet, which needs
+   * packet metadata turned on for every packet of the simulation, even
+   * when a single link is traced.  A summary line only has the fields read
+   * from the PPP and compression headers:
+   *
+   * \code
+   *   - 1.002040000 /NodeList/0/DeviceList/1 uid=42 protocol=0x0021 size=120 original=1002
+   * \endcode
+   *
+   * Times are in seconds with nine decimals, as p2p-binary-trace.py --ascii
+   * prints binary traces.  \c original is only present on compressed frames.  Events are the
+   * same as with SetBinaryTrace, which takes precedence when both are set.
+   *
+   * \param enable true to write summary lines
+   */
+  void SetAsciiSummary (bool enable);
+
+  /**
+   * Add a stage to the transmit pipeline of each PointToPointNetDevice
+   * created by the helper.  Each device gets its own instance.
+   *
+   * \param position where in the pipeline to run the stage
+   * \param type the TypeId of a PointToPointTxStage subclass
+   * \param n1 the name of the attribute to set on the stage
+   * \param v1 the value of the attribute to set on the stage
+   * \param n2 the name of the attribute to set on the stage
+   * \param v2 the value of the attribute to set on the stage
+   * \param n3 the name of the attribute to set on the stage
+   * \param v3 the value of the attribute to set on the stage
+   * \param n4 the name of the attribute to set on the stage
+   * \param v4 the value of the attribute to set on the stage
+   *
+   * \see PointToPointTxStage
+   */
+  void AddTxStage (PointToPointTxStage::Position position, std::string type,
+                   std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                   std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                   std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
+                   std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue ());
+
   /**
    * \param c a set of nodes
    * \return a NetDeviceContainer for nodes
@@ -193,10 +319,35 @@ private:
     Ptr<NetDevice> nd,
     bool explicitFilename);
 
+  /**
+   * \brief Enable binary or summary trace output on the indicated net device.
+   *
+   * \param stream The output stream to use, or 0 to create a file.
+   * \param prefix Filename prefix to use for the trace file.
+   * \param device Net device for which you want to enable tracing.
+   * \param explicitFilename Treat the prefix as an explicit filename if true
+   * \see SetBinaryTrace
+   * \see SetAsciiSummary
+   */
+  void EnableLinkTraceInternal (Ptr<OutputStreamWrapper> stream,
+                                std::string prefix,
+                                Ptr<PointToPointNetDevice> device,
+                                bool explicitFilename);
+
   ObjectFactory m_queueFactory;         //!< Queue Factory
   ObjectFactory m_channelFactory;       //!< Channel Factory
   ObjectFactory m_remoteChannelFactory; //!< Remote Channel Factory
   ObjectFactory m_deviceFactory;        //!< Device Factory
+  bool m_dualViewPcap;                  //!< Write the logical view and index with pcap
+  bool m_asyncTraceWriter;              //!< Write trace files on a background thread
+  bool m_binaryTrace;                   //!< EnableAscii writes binary records
+  bool m_asciiSummary;                  //!< EnableAscii writes summary lines
+  /// Caller-provided streams the binary file header was written to
+  std::set<Ptr<OutputStreamWrapper> > m_binaryStreams;
+  /// Weight and compression policy of each transmit queue
+  std::vector<std::pair<uint32_t, bool> > m_txQueuePolicies;
+  /// Transmit pipeline stage factories, with their position
+  std::vector<std::pair<PointToPointTxStage::Position, ObjectFactory> > m_txStageFactories;
 };
 
 } // namespace ns3
@@ -20,6 +20,9 @@
 #include "udp-app-helper.h"
 #include "ns3/udp-app-server.h"
 #include "ns3/udp-app-client.h"
+#include "ns3/multi-flow-client.h"
+#include "ns3/pcap-replay-client.h"
+#include "ns3/string.h"
 #include "ns3/uinteger.h"
 #include "ns3/names.h"
 
@@ -137,6 +140,25 @@ UdpAppClientHelper::Install (NodeContainer c) const
   return apps;
 }
 
+int64_t
+UdpAppClientHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<UdpAppClient> client = DynamicCast<UdpAppClient> (node->GetApplication (j));
+          if (client)
+            {
+              currentStream += client->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
 Ptr<Application>
 UdpAppClientHelper::InstallPriv (Ptr<Node> node) const
 {
@@ -146,4 +168,117 @@ UdpAppClientHelper::InstallPriv (Ptr<Node> node) const
   return app;
 }
 
+MultiFlowClientHelper::MultiFlowClientHelper (std::string flows)
+{
+  m_factory.SetTypeId (MultiFlowClient::GetTypeId ());
+  SetAttribute ("Flows", StringValue (flows));
+}
+
+void
+MultiFlowClientHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+MultiFlowClientHelper::Install (Ptr<Node> node) const
+{
+  return ApplicationContainer (InstallPriv (node));
+}
+
+ApplicationContainer
+MultiFlowClientHelper::Install (std::string nodeName) const
+{
+  Ptr<Node> node = Names::Find<Node> (nodeName);
+  return ApplicationContainer (InstallPriv (node));
+}
+
+ApplicationContainer
+MultiFlowClientHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (InstallPriv (*i));
+    }
+
+  return apps;
+}
+
+int64_t
+MultiFlowClientHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<MultiFlowClient> client = DynamicCast<MultiFlowClient> (node->GetApplication (j));
+          if (client)
+            {
+              currentStream += client->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
+Ptr<Application>
+MultiFlowClientHelper::InstallPriv (Ptr<Node> node) const
+{
+  Ptr<Application> app = m_factory.Create<MultiFlowClient> ();
+  node->AddApplication (app);
+
+  return app;
+}
+
+PcapReplayClientHelper::PcapReplayClientHelper (Address address, uint16_t port, std::string filename)
+{
+  m_factory.SetTypeId (PcapReplayClient::GetTypeId ());
+  SetAttribute ("RemoteAddress", AddressValue (address));
+  SetAttribute ("RemotePort", UintegerValue (port));
+  SetAttribute ("File", StringValue (filename));
+}
+
+void
+PcapReplayClientHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+PcapReplayClientHelper::Install (Ptr<Node> node) const
+{
+  return ApplicationContainer (InstallPriv (node));
+}
+
+ApplicationContainer
+PcapReplayClientHelper::Install (std::string nodeName) const
+{
+  Ptr<Node> node = Names::Find<Node> (nodeName);
+  return ApplicationContainer (InstallPriv (node));
+}
+
+ApplicationContainer
+PcapReplayClientHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (InstallPriv (*i));
+    }
+
+  return apps;
+}
+
+Ptr<Application>
+PcapReplayClientHelper::InstallPriv (Ptr<Node> node) const
+{
+  Ptr<Application> app = m_factory.Create<PcapReplayClient> ();
+  node->AddApplication (app);
+
+  return app;
+}
+
 } // namespace ns3
@@ -215,6 +215,17 @@ public:
    */
   ApplicationContainer Install (NodeContainer c) const;
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the UdpAppClients on the given nodes.  Return the number of
+   * streams (possibly zero) that have been assigned.
+   *
+   * \param c the nodes whose clients get fixed streams
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
 private:
   /**
    * Install an ns3::UdpAppClient on the node configured with all the
@@ -227,6 +238,137 @@ private:
   ObjectFactory m_factory; //!< Object factory.
 };
 
+/**
+ * \ingroup udpapp
+ * \brief Create an application which drives many UDP flows
+ */
+class MultiFlowClientHelper
+{
+public:
+  /**
+   * Create a MultiFlowClientHelper whose clients send the given flows.
+   *
+   * \param flows the flows, as a JSON array (see MultiFlowClient)
+   */
+  MultiFlowClientHelper (std::string flows);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \param node The node on which to create the MultiFlowClient.
+   *
+   * \returns An ApplicationContainer that holds a Ptr<Application> to the 
+   *          application created
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+  /**
+   * \param nodeName The name of the node on which to create the MultiFlowClient
+   *
+   * \returns An ApplicationContainer that holds a Ptr<Application> to the 
+   *          application created
+   */
+  ApplicationContainer Install (std::string nodeName) const;
+
+  /**
+   * \param c the nodes
+   *
+   * Create one multi-flow client on each of the input nodes
+   *
+   * \returns the applications created, one application per input node.
+   */
+  ApplicationContainer Install (NodeContainer c) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the MultiFlowClients on the given nodes.  Return the number of
+   * streams (possibly zero) that have been assigned.
+   *
+   * \param c the nodes whose clients get fixed streams
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
+private:
+  /**
+   * Install an ns3::MultiFlowClient on the node configured with all the
+   * attributes set with SetAttribute.
+   *
+   * \param node The node on which a MultiFlowClient will be installed.
+   * \returns Ptr to the application installed.
+   */
+  Ptr<Application> InstallPriv (Ptr<Node> node) const;
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+/**
+ * \ingroup udpapp
+ * \brief Create an application which replays the UDP datagrams of a pcap file
+ */
+class PcapReplayClientHelper
+{
+public:
+  /**
+   * Create a PcapReplayClientHelper whose clients replay a capture.
+   *
+   * \param ip The IP address of the remote udp app server
+   * \param port The port number of the remote udp app server
+   * \param filename The pcap file to replay
+   */
+  PcapReplayClientHelper (Address ip, uint16_t port, std::string filename);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \param node The node on which to create the PcapReplayClient.
+   *
+   * \returns An ApplicationContainer that holds a Ptr<Application> to the 
+   *          application created
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+  /**
+   * \param nodeName The name of the node on which to create the PcapReplayClient
+   *
+   * \returns An ApplicationContainer that holds a Ptr<Application> to the 
+   *          application created
+   */
+  ApplicationContainer Install (std::string nodeName) const;
+
+  /**
+   * \param c the nodes
+   *
+   * Create one pcap replay client on each of the input nodes
+   *
+   * \returns the applications created, one application per input node.
+   */
+  ApplicationContainer Install (NodeContainer c) const;
+
+private:
+  /**
+   * Install an ns3::PcapReplayClient on the node configured with all the
+   * attributes set with SetAttribute.
+   *
+   * \param node The node on which a PcapReplayClient will be installed.
+   * \returns Ptr to the application installed.
+   */
+  Ptr<Application> InstallPriv (Ptr<Node> node) const;
+  ObjectFactory m_factory; //!< Object factory.
+};
+
 } // namespace ns3
 
 #endif /* UDP_APP_HELPER_H */
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ppp-header.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/point-to-point-net-device.h"
+#include "compression-flow-probe.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressionFlowProbe");
+
+NS_OBJECT_ENSURE_REGISTERED (CompressionFlowProbe);
+
+TypeId
+CompressionFlowProbe::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CompressionFlowProbe")
+    .SetParent<FlowProbe> ()
+    .SetGroupName ("Applications")
+    // No AddConstructor because this class has no default constructor.
+  ;
+  return tid;
+}
+
+CompressionFlowProbe::CompressionFlowProbe (Ptr<FlowMonitor> monitor,
+                                            Ptr<Ipv4FlowClassifier> classifier,
+                                            Ptr<PointToPointNetDevice> device)
+  : FlowProbe (monitor),
+    m_classifier (classifier),
+    m_lastFlowId (0)
+{
+  NS_LOG_FUNCTION (this << monitor << classifier << device);
+  if (!device->TraceConnectWithoutContext ("Compress",
+                                           MakeCallback (&CompressionFlowProbe::CompressLogger,
+                                                         Ptr<CompressionFlowProbe> (this))))
+    {
+      NS_FATAL_ERROR ("trace fail");
+    }
+}
+
+CompressionFlowProbe::~CompressionFlowProbe ()
+{
+}
+
+void
+CompressionFlowProbe::DoDispose (void)
+{
+  m_classifier = 0;
+  FlowProbe::DoDispose ();
+}
+
+double
+CompressionFlowProbe::CompressionStats::GetRatio (void) const
+{
+  return wireBytes ? static_cast<double> (originalBytes) / wireBytes : 0.0;
+}
+
+const CompressionFlowProbe::CompressionStatsContainer &
+CompressionFlowProbe::GetCompressionStats (void) const
+{
+  return m_compressionStats;
+}
+
+bool
+CompressionFlowProbe::LookupFlow (const Ipv4FlowClassifier::FiveTuple &tuple, FlowId *flowId)
+{
+  std::map<Ipv4FlowClassifier::FiveTuple, FlowId>::const_iterator it = m_flowIds.find (tuple);
+  if (it == m_flowIds.end ())
+    {
+      // Not a flow we know.  Flow ids only grow, so the cache only needs
+      // the flows the monitor added since the last look, if any; packets of
+      // unmonitored flows cost a lookup, not a scan of every flow.
+      const FlowMonitor::FlowStatsContainer &flows = m_flowMonitor->GetFlowStats ();
+      if (flows.empty () || flows.rbegin ()->first == m_lastFlowId)
+        {
+          return false;
+        }
+      for (FlowMonitor::FlowStatsContainerCI flow = flows.upper_bound (m_lastFlowId); flow != flows.end (); ++flow)
+        {
+          m_flowIds[m_classifier->FindFlow (flow->first)] = flow->first;
+        }
+      m_lastFlowId = flows.rbegin ()->first;
+      it = m_flowIds.find (tuple);
+      if (it == m_flowIds.end ())
+        {
+          return false;
+        }
+    }
+  *flowId = it->second;
+  return true;
+}
+
+void
+CompressionFlowProbe::CompressLogger (Ptr<const Packet> packet, uint32_t originalSize,
+                                      uint32_t compressedSize, int64_t nanoseconds)
+{
+  NS_LOG_FUNCTION (this << packet << originalSize << compressedSize << nanoseconds);
+
+  uint8_t version;
+  packet->CopyData (&version, 1);
+  if ((version >> 4) != 4)
+    {
+      return;
+    }
+
+  Ipv4Header ipHeader;
+  packet->PeekHeader (ipHeader);
+  if (ipHeader.GetFragmentOffset () != 0
+      || (ipHeader.GetProtocol () != 6 && ipHeader.GetProtocol () != 17))
+    {
+      // Ipv4FlowClassifier only knows about the first fragment of TCP and UDP packets
+      return;
+    }
+
+  // Both TCP and UDP start with the source and destination ports
+  uint32_t ipSize = ipHeader.GetSerializedSize ();
+  uint8_t data[64];
+  if (packet->CopyData (data, ipSize + 4) < ipSize + 4)
+    {
+      return;
+    }
+  Ipv4FlowClassifier::FiveTuple tuple;
+  tuple.sourceAddress = ipHeader.GetSource ();
+  tuple.destinationAddress = ipHeader.GetDestination ();
+  tuple.protocol = ipHeader.GetProtocol ();
+  tuple.sourcePort = (data[ipSize] << 8) | data[ipSize + 1];
+  tuple.destinationPort = (data[ipSize + 2] << 8) | data[ipSize + 3];
+
+  FlowId flowId;
+  if (!LookupFlow (tuple, &flowId))
+    {
+      NS_LOG_LOGIC ("Packet " << packet->GetUid () << " belongs to an unmonitored flow");
+      return;
+    }
+
+  PppHeader ppp;
+  uint32_t wireBytes = compressedSize + ppp.GetSerializedSize ();
+  CompressionStats &stats = m_compressionStats[flowId];
+  stats.originalBytes += originalSize;
+  stats.wireBytes += wireBytes;
+  stats.packets++;
+  stats.nanoseconds += nanoseconds;
+}
+
+void
+CompressionFlowProbe::SerializeCompressionToXmlStream (std::ostream &os, uint16_t indent, uint32_t index) const
+{
+#define INDENT(level) for (int __xpto = 0; __xpto < level; __xpto++) os << ' ';
+
+  INDENT (indent); os << "<CompressionProbe index=\"" << index << "\">\n";
+
+  indent += 2;
+  for (CompressionStatsContainer::const_iterator iter = m_compressionStats.begin (); iter != m_compressionStats.end (); iter++)
+    {
+      INDENT (indent);
+      os << "<FlowStats "
+         << " flowId=\"" << iter->first << "\""
+         << " packets=\"" << iter->second.packets << "\""
+         << " originalBytes=\"" << iter->second.originalBytes << "\""
+         << " wireBytes=\"" << iter->second.wireBytes << "\""
+         << " compressionRatio=\"" << iter->second.GetRatio () << "\""
+         << " compressNanoseconds=\"" << iter->second.nanoseconds << "\""
+         << " />\n";
+    }
+  indent -= 2;
+  INDENT (indent); os << "</CompressionProbe>\n";
+
+#undef INDENT
+}
+
+} // namespace ns3
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPRESSION_FLOW_PROBE_H
+#define COMPRESSION_FLOW_PROBE_H
+
+#include <map>
+#include <ostream>
+#include "ns3/flow-probe.h"
+#include "ns3/ipv4-flow-classifier.h"
+
+namespace ns3 {
+
+class FlowMonitor;
+class PointToPointNetDevice;
+class Packet;
+
+/**
+ * \ingroup udpapp
+ * \brief FlowProbe attached to the compressing side of a compression link
+ *
+ * The probe listens to the PointToPointNetDevice "Compress" trace source
+ * and accounts, per Ipv4FlowClassifier 5-tuple, the bytes handed to the
+ * compressor, the bytes put on the wire and the wall-clock time spent in
+ * deflate.  CompressionFlowMonitorHelper writes them next to the FlowMonitor
+ * XML output.  They are not reported through the regular FlowProbe
+ * statistics: the device does not know when a packet was first seen, and
+ * a zero delay would skew the delay statistics of the probe.
+ *
+ * Only IPv4 flows are accounted.  Flows the FlowMonitor has not classified
+ * (e.g. because the sending node is not monitored) are ignored.
+ */
+class CompressionFlowProbe : public FlowProbe
+{
+public:
+  /**
+   * \param monitor the FlowMonitor this probe reports to
+   * \param classifier the IPv4 classifier used by monitor
+   * \param device the compressing PointToPointNetDevice
+   */
+  CompressionFlowProbe (Ptr<FlowMonitor> monitor,
+                        Ptr<Ipv4FlowClassifier> classifier,
+                        Ptr<PointToPointNetDevice> device);
+  virtual ~CompressionFlowProbe ();
+
+  /**
+   * \brief Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /// Compression accounting of one flow
+  struct CompressionStats
+  {
+    CompressionStats () : originalBytes (0), wireBytes (0), packets (0), nanoseconds (0) {}
+    uint64_t originalBytes; //!< IP bytes handed to the compressor
+    uint64_t wireBytes;     //!< Bytes on the wire, including PPP and compression headers
+    uint32_t packets;       //!< Number of compressed packets
+    uint64_t nanoseconds;   //!< Wall-clock time spent in deflate
+
+    /// \return originalBytes / wireBytes, or 0 when nothing was sent
+    double GetRatio (void) const;
+  };
+
+  /// Container to map FlowId -> CompressionStats
+  typedef std::map<FlowId, CompressionStats> CompressionStatsContainer;
+
+  /// \return the per-flow compression statistics collected so far
+  const CompressionStatsContainer & GetCompressionStats (void) const;
+
+  /**
+   * \brief Write the per-flow compression statistics as XML
+   * \param os the output stream
+   * \param indent number of spaces to use as base indentation level
+   * \param index the index of this probe in FlowMonitor::GetAllProbes ()
+   */
+  void SerializeCompressionToXmlStream (std::ostream &os, uint16_t indent, uint32_t index) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Sink for PointToPointNetDevice::Compress
+   * \param packet the uncompressed packet, starting with its IP header
+   * \param originalSize the payload size before compression
+   * \param compressedSize the size after compression, without the PPP header
+   * \param nanoseconds wall-clock time spent in deflate
+   */
+  void CompressLogger (Ptr<const Packet> packet, uint32_t originalSize,
+                       uint32_t compressedSize, int64_t nanoseconds);
+
+  /**
+   * \param tuple the 5-tuple of a packet
+   * \param flowId set to the FlowMonitor flow id of tuple
+   * \return true if the FlowMonitor knows the flow
+   */
+  bool LookupFlow (const Ipv4FlowClassifier::FiveTuple &tuple, FlowId *flowId);
+
+  Ptr<Ipv4FlowClassifier> m_classifier; //!< Classifier of the FlowMonitor
+  std::map<Ipv4FlowClassifier::FiveTuple, FlowId> m_flowIds; //!< 5-tuple -> FlowId cache
+  FlowId m_lastFlowId;                  //!< Largest flow id in m_flowIds, 0 if none
+  CompressionStatsContainer m_compressionStats; //!< Per-flow compression stats
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSION_FLOW_PROBE_H */
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "crc32c.h"
+#include <string.h>
+
+#if defined (__x86_64__) && defined (__GNUC__)
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif defined (__aarch64__) && defined (__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM 1
+#endif
+
+namespace ns3 {
+
+/// Reflected Castagnoli polynomial
+static const uint32_t CRC32C_POLY = 0x82f63b78;
+
+/// Slicing-by-8 lookup tables, built on first use
+static uint32_t g_crc32cTable[8][256];
+
+static void
+Crc32cInitTable (void)
+{
+  for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t crc = i;
+      for (int j = 0; j < 8; ++j)
+        {
+          crc = (crc >> 1) ^ (CRC32C_POLY & (0 - (crc & 1)));
+        }
+      g_crc32cTable[0][i] = crc;
+    }
+  for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t crc = g_crc32cTable[0][i];
+      for (int k = 1; k < 8; ++k)
+        {
+          crc = g_crc32cTable[0][crc & 0xff] ^ (crc >> 8);
+          g_crc32cTable[k][i] = crc;
+        }
+    }
+}
+
+static uint32_t
+Crc32cSoftware (const uint8_t *data, uint32_t length)
+{
+  uint32_t crc = 0xffffffff;
+  while (length >= 8)
+    {
+      uint32_t lo;
+      uint32_t hi;
+      memcpy (&lo, data, 4);
+      memcpy (&hi, data + 4, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      lo = __builtin_bswap32 (lo);
+      hi = __builtin_bswap32 (hi);
+#endif
+      lo ^= crc;
+      crc = g_crc32cTable[7][lo & 0xff] ^
+        g_crc32cTable[6][(lo >> 8) & 0xff] ^
+        g_crc32cTable[5][(lo >> 16) & 0xff] ^
+        g_crc32cTable[4][lo >> 24] ^
+        g_crc32cTable[3][hi & 0xff] ^
+        g_crc32cTable[2][(hi >> 8) & 0xff] ^
+        g_crc32cTable[1][(hi >> 16) & 0xff] ^
+        g_crc32cTable[0][hi >> 24];
+      data += 8;
+      length -= 8;
+    }
+  while (length--)
+    {
+      crc = g_crc32cTable[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+  return ~crc;
+}
+
+#if defined (CRC32C_X86)
+__attribute__ ((target ("sse4.2")))
+static uint32_t
+Crc32cHardware (const uint8_t *data, uint32_t length)
+{
+  uint64_t crc = 0xffffffff;
+  while (length >= 8)
+    {
+      uint64_t word;
+      memcpy (&word, data, 8);
+      crc = _mm_crc32_u64 (crc, word);
+      data += 8;
+      length -= 8;
+    }
+  uint32_t crc32 = static_cast<uint32_t> (crc);
+  while (length--)
+    {
+      crc32 = _mm_crc32_u8 (crc32, *data++);
+    }
+  return ~crc32;
+}
+#elif defined (CRC32C_ARM)
+static uint32_t
+Crc32cHardware (const uint8_t *data, uint32_t length)
+{
+  uint32_t crc = 0xffffffff;
+  while (length >= 8)
+    {
+      uint64_t word;
+      memcpy (&word, data, 8);
+      crc = __crc32cd (crc, word);
+      data += 8;
+      length -= 8;
+    }
+  while (length--)
+    {
+      crc = __crc32cb (crc, *data++);
+    }
+  return ~crc;
+}
+#endif
+
+/// Implementation selected on first use
+typedef uint32_t (*Crc32cFunction)(const uint8_t *, uint32_t);
+
+static Crc32cFunction
+Crc32cSelect (void)
+{
+#if defined (CRC32C_X86)
+  // may run from a static initializer, before the compiler's own cpu probe
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("sse4.2"))
+    {
+      return &Crc32cHardware;
+    }
+#elif defined (CRC32C_ARM)
+  return &Crc32cHardware;
+#endif
+  Crc32cInitTable ();
+  return &Crc32cSoftware;
+}
+
+static Crc32cFunction g_crc32c = Crc32cSelect ();
+
+uint32_t
+CRC32CCalculate (const uint8_t *data, uint32_t length)
+{
+  return g_crc32c (data, length);
+}
+
+bool
+CRC32CIsHardwareAccelerated (void)
+{
+  return g_crc32c != &Crc32cSoftware;
+}
+
+} // namespace ns3
@@ -0,0 +1,42 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef CRC32C_H
+#define CRC32C_H
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * Calculates the CRC-32C (Castagnoli) for a given input
+ *
+ * The SSE4.2 (x86-64) or ARMv8 CRC32 instructions are used when the CPU
+ * running the simulation has them, otherwise a slicing-by-8 table
+ * implementation is used.  Both produce identical results.
+ *
+ * \param data buffer to calculate the checksum for
+ * \param length the length of the buffer (bytes)
+ * \returns the computed crc-32c.
+ */
+uint32_t CRC32CCalculate (const uint8_t *data, uint32_t length);
+
+/**
+ * \returns true if CRC32CCalculate uses hardware CRC32 instructions.
+ */
+bool CRC32CIsHardwareAccelerated (void);
+
+} // namespace ns3
+
+#endif
@@ -0,0 +1,372 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <nlohmann/json.hpp>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/object-factory.h"
+#include "ns3/trace-source-accessor.h"
+#include "multi-flow-client.h"
+#include "payload-generator.h"
+#include "send-time-tag.h"
+
+using json = nlohmann::json;
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultiFlowClient");
+
+NS_OBJECT_ENSURE_REGISTERED (MultiFlowClient);
+
+TypeId
+MultiFlowClient::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultiFlowClient")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<MultiFlowClient> ()
+    .AddAttribute ("Flows",
+                   "JSON array of flows to add, e.g. [{\"address\": \"10.1.2.4\", "
+                   "\"port\": 4000, \"rate\": \"1Mbps\", \"flows\": 100}]",
+                   StringValue (""),
+                   MakeStringAccessor (&MultiFlowClient::SetFlows,
+                                       &MultiFlowClient::GetFlows),
+                   MakeStringChecker ())
+    .AddAttribute ("Tick",
+                   "Resolution of the send times of the flows",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&MultiFlowClient::m_tick),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("PayloadGenerator",
+                   "Generator of the high entropy payloads, e.g. "
+                   "ns3::EntropyPayloadGenerator[Entropy=4]",
+                   StringValue ("ns3::RandomPayloadGenerator"),
+                   MakePointerAccessor (&MultiFlowClient::m_payloadGenerator),
+                   MakePointerChecker<PayloadGenerator> ())
+    .AddTraceSource ("Tx", "A packet of a flow is sent",
+                     MakeTraceSourceAccessor (&MultiFlowClient::m_txTrace),
+                     "ns3::MultiFlowClient::TxTracedCallback")
+  ;
+  return tid;
+}
+
+MultiFlowClient::MultiFlowClient ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MultiFlowClient::~MultiFlowClient ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultiFlowClient::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flows.clear ();
+  m_sizes.clear ();
+  m_payloadGenerator = 0;
+  m_socket = 0;
+  m_socket6 = 0;
+  m_wheel.Clear ();
+  Application::DoDispose ();
+}
+
+uint32_t
+MultiFlowClient::AddFlow (Address remote, Ptr<RandomVariableStream> size, DataRate rate,
+                          uint32_t packets, Time start, bool high)
+{
+  NS_LOG_FUNCTION (this << remote << size << rate << packets << start << high);
+  NS_ABORT_MSG_UNLESS (InetSocketAddress::IsMatchingType (remote) || Inet6SocketAddress::IsMatchingType (remote),
+                       "MultiFlowClient::AddFlow(): the destination needs an address and a port");
+  NS_ABORT_MSG_UNLESS (rate.GetBitRate () > 0, "MultiFlowClient::AddFlow(): the rate must not be 0");
+  std::vector<Ptr<RandomVariableStream> >::iterator i = std::find (m_sizes.begin (), m_sizes.end (), size);
+  Flow flow;
+  flow.next = 0;
+  flow.bitRate = rate.GetBitRate ();
+  flow.remote = GetRemote (remote);
+  flow.size = i - m_sizes.begin ();
+  flow.packets = packets;
+  flow.sent = 0;
+  flow.start = start;
+  flow.high = high;
+  if (i == m_sizes.end ())
+    {
+      m_sizes.push_back (size);
+    }
+  m_flows.push_back (flow);
+  return m_flows.size () - 1;
+}
+
+uint32_t
+MultiFlowClient::GetNFlows (void) const
+{
+  return m_flows.size ();
+}
+
+uint32_t
+MultiFlowClient::GetSent (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flows.size ());
+  return m_flows[flow].sent;
+}
+
+int64_t
+MultiFlowClient::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  for (uint32_t i = 0; i < m_sizes.size (); i++)
+    {
+      m_sizes[i]->SetStream (stream + i);
+    }
+  return m_sizes.size () + m_payloadGenerator->AssignStreams (stream + m_sizes.size ());
+}
+
+void
+MultiFlowClient::SetFlows (std::string flows)
+{
+  NS_LOG_FUNCTION (this << flows);
+  m_flowsSpec = flows;
+  if (flows.empty ())
+    {
+      return;
+    }
+  // Entries of the same size share its random variable
+  std::map<std::string, Ptr<RandomVariableStream> > sizes;
+  try
+    {
+      json j = json::parse (flows);
+      for (json::const_iterator it = j.begin (); it != j.end (); ++it)
+        {
+          std::string address = it->at ("address").get<std::string> ();
+          uint16_t port = it->at ("port").get<uint16_t> ();
+          Address remote;
+          if (address.find (':') != std::string::npos)
+            {
+              remote = Inet6SocketAddress (Ipv6Address (address.c_str ()), port);
+            }
+          else
+            {
+              remote = InetSocketAddress (Ipv4Address (address.c_str ()), port);
+            }
+          DataRate rate (it->at ("rate").get<std::string> ());
+
+          std::string sizeSpec = it->count ("size") ? it->at ("size").dump () : "1024";
+          Ptr<RandomVariableStream> &size = sizes[sizeSpec];
+          if (!size && (!it->count ("size") || it->at ("size").is_number ()))
+            {
+              size = CreateObject<ConstantRandomVariable> ();
+              size->SetAttribute ("Constant", DoubleValue (it->count ("size") ? it->at ("size").get<double> () : 1024));
+            }
+          else if (!size)
+            {
+              ObjectFactory factory;
+              std::istringstream spec (it->at ("size").get<std::string> ());
+              spec >> factory;
+              size = factory.Create<RandomVariableStream> ();
+              NS_ABORT_MSG_UNLESS (size, "MultiFlowClient flow size " << sizeSpec << " is not a random variable");
+            }
+
+          uint32_t packets = it->count ("packets") ? it->at ("packets").get<uint32_t> () : 0;
+          Time start = it->count ("start") ? Time (it->at ("start").get<std::string> ()) : Seconds (0);
+          std::string type = it->count ("type") ? it->at ("type").get<std::string> () : "high";
+          if (type != "high" && type != "low")
+            {
+              NS_FATAL_ERROR ("MultiFlowClient flow type must be low or high, not \"" << type << "\"");
+            }
+          uint32_t copies = it->count ("flows") ? it->at ("flows").get<uint32_t> () : 1;
+          for (uint32_t i = 0; i < copies; i++)
+            {
+              AddFlow (remote, size, rate, packets, start, type == "high");
+            }
+        }
+    }
+  catch (json::exception &e)
+    {
+      NS_FATAL_ERROR ("Malformed MultiFlowClient flows " << flows << ": " << e.what ());
+    }
+}
+
+std::string
+MultiFlowClient::GetFlows (void) const
+{
+  return m_flowsSpec;
+}
+
+uint32_t
+MultiFlowClient::GetRemote (Address remote)
+{
+  std::map<Address, uint32_t>::const_iterator i = m_remoteIndex.find (remote);
+  if (i != m_remoteIndex.end ())
+    {
+      return i->second;
+    }
+  m_remotes.push_back (remote);
+  m_remoteIndex[remote] = m_remotes.size () - 1;
+  return m_remotes.size () - 1;
+}
+
+Ptr<Socket>
+MultiFlowClient::GetSocket (const Address &remote)
+{
+  bool v6 = Inet6SocketAddress::IsMatchingType (remote);
+  Ptr<Socket> &socket = v6 ? m_socket6 : m_socket;
+  if (socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      socket = Socket::CreateSocket (GetNode (), tid);
+      if ((v6 ? socket->Bind6 () : socket->Bind ()) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      socket->SetRecvCallback (MakeCallback (&MultiFlowClient::HandleRead, this));
+      socket->SetAllowBroadcast (true);
+    }
+  return socket;
+}
+
+uint64_t
+MultiFlowClient::GetTick (int64_t time) const
+{
+  int64_t tick = m_tick.GetTimeStep ();
+  return (time + tick - 1) / tick;
+}
+
+void
+MultiFlowClient::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (m_tick.IsStrictlyPositive (), "MultiFlowClient Tick must be positive");
+
+  // Bring the empty wheel to now, so that ticks are inserted relative to it
+  m_expired.clear ();
+  m_wheel.Advance (Simulator::Now ().GetTimeStep () / m_tick.GetTimeStep (), m_expired);
+
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      Flow &flow = m_flows[i];
+      GetSocket (m_remotes[flow.remote]);
+      flow.next = (Simulator::Now () + flow.start).GetTimeStep ();
+      if (flow.packets == 0 || flow.sent < flow.packets)
+        {
+          m_wheel.Insert (i, GetTick (flow.next));
+        }
+    }
+  NS_LOG_INFO ("Starting " << m_wheel.GetSize () << " flows");
+  ScheduleTick ();
+}
+
+void
+MultiFlowClient::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_tickEvent);
+  m_wheel.Clear ();
+  Ptr<Socket> sockets[] = { m_socket, m_socket6 };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      if (sockets[i] != 0)
+        {
+          sockets[i]->Close ();
+          sockets[i]->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+        }
+    }
+  m_socket = 0;
+  m_socket6 = 0;
+}
+
+void
+MultiFlowClient::ScheduleTick (void)
+{
+  uint64_t next = m_wheel.GetNextTick ();
+  if (next == UINT64_MAX)
+    {
+      NS_LOG_INFO ("All flows are done");
+      return;
+    }
+  Time at = TimeStep (next * m_tick.GetTimeStep ());
+  m_tickEvent = Simulator::Schedule (Max (at - Simulator::Now (), Seconds (0)),
+                                     &MultiFlowClient::HandleTick, this);
+}
+
+void
+MultiFlowClient::HandleTick (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t now = Simulator::Now ().GetTimeStep () / m_tick.GetTimeStep ();
+  m_expired.clear ();
+  m_wheel.Advance (now, m_expired);
+  for (std::vector<uint32_t>::const_iterator i = m_expired.begin (); i != m_expired.end (); ++i)
+    {
+      const Flow &flow = m_flows[*i];
+      // A flow faster than a tick sends all its packets of the tick at once
+      do
+        {
+          SendPacket (*i);
+        }
+      while ((flow.packets == 0 || flow.sent < flow.packets) && GetTick (flow.next) <= now);
+      if (flow.packets == 0 || flow.sent < flow.packets)
+        {
+          m_wheel.Insert (*i, GetTick (flow.next));
+        }
+    }
+  ScheduleTick ();
+}
+
+void
+MultiFlowClient::SendPacket (uint32_t index)
+{
+  Flow &flow = m_flows[index];
+  const Address &remote = m_remotes[flow.remote];
+  uint32_t size = m_sizes[flow.size]->GetInteger ();
+  Ptr<Packet> p = flow.high ? m_payloadGenerator->CreatePacket (size) : Create<Packet> (size);
+  p->AddPacketTag (SendTimeTag (TimeStep (flow.next)));
+  m_txTrace (p, index);
+  GetSocket (remote)->SendTo (p, 0, remote);
+  NS_LOG_LOGIC ("Flow " << index << " sent " << p->GetSize () << " bytes");
+
+  flow.sent++;
+  // The next packet waits until this one has gone at the rate of the flow
+  int64_t interval = DataRate (flow.bitRate).CalculateBytesTxTime (p->GetSize ()).GetTimeStep ();
+  flow.next += std::max<int64_t> (interval, 1);
+}
+
+void
+MultiFlowClient::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      NS_LOG_LOGIC ("Received " << packet->GetSize () << " bytes");
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTI_FLOW_CLIENT_H
+#define MULTI_FLOW_CLIENT_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "timer-wheel.h"
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+class PayloadGenerator;
+
+/**
+ * \ingroup udpapp
+ * \brief A UDP client driving many flows from one application
+ *
+ * Each flow has a destination, a payload size distribution, a rate, a
+ * number of packets and a start time.  Instead of an application, a socket
+ * and an event per flow, the client keeps the flows in one array, sends
+ * from one socket per address family, and keeps their next send times in a
+ * TimerWheel, with a single simulator event pending for the next tick that
+ * has work.  Memory and events grow with the number of active flows only.
+ *
+ * Flows are added with AddFlow, or with the Flows attribute, a JSON array:
+ * \code
+ * [{"address": "10.1.2.4", "port": 4000, "rate": "1Mbps",
+ *   "size": "ns3::UniformRandomVariable[Min=64|Max=1500]",
+ *   "packets": 1000, "start": "1s", "type": "high", "flows": 500}]
+ * \endcode
+ * address, port and rate are required.  size is a number of bytes or a
+ * random variable (1024 by default), packets 0 means no limit, type is
+ * high (from PayloadGenerator) or low (zeros), and flows repeats the entry.
+ * Flows sharing a size distribution share its stream.  Setting the
+ * attribute adds its flows to those already there.
+ *
+ * Send times are rounded up to Tick.  Each packet carries its send time
+ * in a SendTimeTag.
+ */
+class MultiFlowClient : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MultiFlowClient ();
+  virtual ~MultiFlowClient ();
+
+  /**
+   * \brief Add a flow
+   * \param remote the destination, an InetSocketAddress or Inet6SocketAddress
+   * \param size the payload size of each packet, in bytes
+   * \param rate the rate of the flow, which spaces its packets by their size
+   * \param packets the number of packets to send, or 0 for no limit
+   * \param start when the flow starts, after the application
+   * \param high whether the payloads come from PayloadGenerator, or are zeros
+   * \return the index of the flow
+   */
+  uint32_t AddFlow (Address remote, Ptr<RandomVariableStream> size, DataRate rate,
+                    uint32_t packets = 0, Time start = Seconds (0), bool high = true);
+
+  /**
+   * \return the number of flows
+   */
+  uint32_t GetNFlows (void) const;
+
+  /**
+   * \param flow the index of a flow
+   * \return the number of packets the flow has sent
+   */
+  uint32_t GetSent (uint32_t flow) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * TracedCallback signature for packets sent by a flow.
+   *
+   * \param [in] packet The packet.
+   * \param [in] flow The index of the flow.
+   */
+  typedef void (* TxTracedCallback)(Ptr<const Packet> packet, uint32_t flow);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /// The state of a flow
+  struct Flow
+  {
+    int64_t next;     //!< Time step of the next packet
+    uint64_t bitRate; //!< Rate in bits per second
+    uint32_t remote;  //!< Index of the destination in m_remotes
+    uint32_t size;    //!< Index of the size distribution in m_sizes
+    uint32_t packets; //!< Packets to send, or 0 for no limit
+    uint32_t sent;    //!< Packets sent
+    Time start;       //!< Start, after the application
+    bool high;        //!< High entropy payloads, otherwise zeros
+  };
+
+  /**
+   * \brief Add the flows of a JSON array
+   * \param flows the array, as described for the Flows attribute
+   */
+  void SetFlows (std::string flows);
+
+  /**
+   * \return the flows added through the Flows attribute
+   */
+  std::string GetFlows (void) const;
+
+  /**
+   * \brief Send the packets of every flow whose tick has come
+   */
+  void HandleTick (void);
+
+  /**
+   * \brief Schedule HandleTick for the next tick of the wheel with work
+   */
+  void ScheduleTick (void);
+
+  /**
+   * \brief Build and send one packet of a flow
+   * \param index the index of the flow
+   */
+  void SendPacket (uint32_t index);
+
+  /**
+   * \param time a time
+   * \return the first tick at or after it
+   */
+  uint64_t GetTick (int64_t time) const;
+
+  /**
+   * \param remote a destination
+   * \return its index in m_remotes, which it is added to if need be
+   */
+  uint32_t GetRemote (Address remote);
+
+  /**
+   * \param remote a destination
+   * \return the socket to send to it from, created on first use
+   */
+  Ptr<Socket> GetSocket (const Address &remote);
+
+  /**
+   * \brief Handle a packet reception.
+   *
+   * This function is called by lower layers.
+   *
+   * \param socket the socket the packet was received to.
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  std::vector<Flow> m_flows;                     //!< The flows
+  std::vector<Address> m_remotes;                //!< Their distinct destinations
+  std::map<Address, uint32_t> m_remoteIndex;     //!< Index of each destination in m_remotes
+  std::vector<Ptr<RandomVariableStream> > m_sizes; //!< Their distinct size distributions
+  std::string m_flowsSpec;                       //!< The flows set through the attribute
+  Time m_tick;                                   //!< Resolution of the send times
+  Ptr<PayloadGenerator> m_payloadGenerator;      //!< Builds the high entropy payloads
+  Ptr<Socket> m_socket;                          //!< IPv4 socket
+  Ptr<Socket> m_socket6;                         //!< IPv6 socket
+  TimerWheel m_wheel;                            //!< Ticks of the next packet of the flows
+  std::vector<uint32_t> m_expired;               //!< Reused for the flows due at a tick
+  EventId m_tickEvent;                           //!< Event of the next tick with work
+
+  /// Callbacks for tracing the packet Tx events
+  TracedCallback<Ptr<const Packet>, uint32_t> m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* MULTI_FLOW_CLIENT_H */
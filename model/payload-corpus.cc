@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "payload-corpus.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PayloadCorpus");
+
+namespace {
+
+/**
+ * \return the corpora mapped so far, by file name
+ */
+std::map<std::string, Ptr<const PayloadCorpus> > &
+Corpora (void)
+{
+  static std::map<std::string, Ptr<const PayloadCorpus> > corpora;
+  return corpora;
+}
+
+} // anonymous namespace
+
+Ptr<const PayloadCorpus>
+PayloadCorpus::Get (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::map<std::string, Ptr<const PayloadCorpus> >::iterator it = Corpora ().find (filename);
+  if (it != Corpora ().end ())
+    {
+      return it->second;
+    }
+  Ptr<const PayloadCorpus> corpus = Ptr<const PayloadCorpus> (new PayloadCorpus (filename), false);
+  Corpora ()[filename] = corpus;
+  return corpus;
+}
+
+PayloadCorpus::PayloadCorpus (std::string filename)
+  : m_filename (filename),
+    m_data (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this << filename);
+  int fd = open (filename.c_str (), O_RDONLY);
+  NS_ABORT_MSG_IF (fd < 0, "PayloadCorpus: unable to open " << filename);
+  struct stat st;
+  NS_ABORT_MSG_IF (fstat (fd, &st) != 0 || st.st_size == 0,
+                   "PayloadCorpus: " << filename << " is empty or unreadable");
+  void *data = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the descriptor is closed
+  close (fd);
+  NS_ABORT_MSG_IF (data == MAP_FAILED, "PayloadCorpus: unable to map " << filename);
+  m_data = static_cast<const uint8_t *> (data);
+  m_size = st.st_size;
+  NS_LOG_INFO ("Mapped " << m_size << " bytes of " << filename);
+}
+
+PayloadCorpus::~PayloadCorpus ()
+{
+  NS_LOG_FUNCTION (this);
+  munmap (const_cast<uint8_t *> (m_data), m_size);
+}
+
+const uint8_t *
+PayloadCorpus::GetData (void) const
+{
+  return m_data;
+}
+
+uint64_t
+PayloadCorpus::GetSize (void) const
+{
+  return m_size;
+}
+
+const uint8_t *
+PayloadCorpus::GetPayload (uint64_t offset, uint32_t size) const
+{
+  NS_ABORT_MSG_IF (size > m_size, "PayloadCorpus: " << m_filename << " holds " << m_size
+                   << " bytes, smaller than a payload of " << size);
+  return m_data + offset % (m_size - size + 1);
+}
+
+std::string
+PayloadCorpus::GetFilename (void) const
+{
+  return m_filename;
+}
+
+} // namespace ns3
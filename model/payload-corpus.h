@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PAYLOAD_CORPUS_H
+#define PAYLOAD_CORPUS_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup udpapp
+ * \brief A read-only file of payload bytes shared by every application
+ *
+ * The file is mapped into memory once per process, however many
+ * applications use it; each of them only keeps an offset into it.  Any file
+ * can serve as a corpus: random data, text, JSON, media, ...
+ */
+class PayloadCorpus : public SimpleRefCount<PayloadCorpus>
+{
+public:
+  /**
+   * \brief Get the corpus of a file, mapping it on first use
+   * \param filename the file
+   * \return the corpus, shared with every other caller for that file
+   */
+  static Ptr<const PayloadCorpus> Get (std::string filename);
+
+  ~PayloadCorpus ();
+
+  /**
+   * \return the first byte of the file
+   */
+  const uint8_t *GetData (void) const;
+
+  /**
+   * \return the size of the file in bytes
+   */
+  uint64_t GetSize (void) const;
+
+  /**
+   * \brief Get size bytes starting at offset, wrapping around at the end
+   *
+   * offset is taken modulo the number of places a whole payload of size
+   * bytes starts in the file, so any offset gives a valid payload.
+   *
+   * \param offset where the payload starts
+   * \param size the size of the payload, at most GetSize ()
+   * \return the first byte of the payload
+   */
+  const uint8_t *GetPayload (uint64_t offset, uint32_t size) const;
+
+  /**
+   * \return the name of the file
+   */
+  std::string GetFilename (void) const;
+
+private:
+  /**
+   * \brief Map a file
+   * \param filename the file
+   */
+  PayloadCorpus (std::string filename);
+
+  std::string m_filename; //!< The file
+  const uint8_t *m_data;  //!< The mapped file
+  uint64_t m_size;        //!< Size of the file
+};
+
+} // namespace ns3
+
+#endif /* PAYLOAD_CORPUS_H */
@@ -0,0 +1,469 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "payload-generator.h"
+#include "random-payload.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PayloadGenerator");
+
+NS_OBJECT_ENSURE_REGISTERED (PayloadGenerator);
+NS_OBJECT_ENSURE_REGISTERED (RandomPayloadGenerator);
+NS_OBJECT_ENSURE_REGISTERED (EntropyPayloadGenerator);
+NS_OBJECT_ENSURE_REGISTERED (PatternPayloadGenerator);
+NS_OBJECT_ENSURE_REGISTERED (MarkovPayloadGenerator);
+NS_OBJECT_ENSURE_REGISTERED (ImixPayloadGenerator);
+
+namespace {
+
+/**
+ * \return the buffer payloads are built in, shared by all generators
+ * since packets copy it
+ */
+std::vector<uint8_t> &
+PayloadScratch (void)
+{
+  static std::vector<uint8_t> scratch;
+  return scratch;
+}
+
+/// Training text of MarkovPayloadGenerator when no file is given
+const char *MARKOV_SAMPLE_TEXT =
+  "It was the best of times, it was the worst of times, it was the age of "
+  "wisdom, it was the age of foolishness, it was the epoch of belief, it was "
+  "the epoch of incredulity, it was the season of Light, it was the season "
+  "of Darkness, it was the spring of hope, it was the winter of despair, we "
+  "had everything before us, we had nothing before us, we were all going "
+  "direct to Heaven, we were all going direct the other way - in short, the "
+  "period was so far like the present period, that some of its noisiest "
+  "authorities insisted on its being received, for good or for evil, in the "
+  "superlative degree of comparison only. There were a king with a large jaw "
+  "and a queen with a plain face, on the throne of England; there were a king "
+  "with a large jaw and a queen with a fair face, on the throne of France. In "
+  "both countries it was clearer than crystal to the lords of the State "
+  "preserves of loaves and fishes, that things in general were settled for "
+  "ever. ";
+
+/**
+ * \param p the probability of byte 0, the other 255 values sharing the rest
+ * \return the entropy of the byte distribution, in bits
+ */
+double
+ZeroBiasedEntropy (double p)
+{
+  double h = 0;
+  if (p > 0)
+    {
+      h -= p * std::log2 (p);
+    }
+  if (p < 1)
+    {
+      h -= (1 - p) * std::log2 ((1 - p) / 255);
+    }
+  return h;
+}
+
+} // anonymous namespace
+
+TypeId
+PayloadGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PayloadGenerator")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("Rng",
+                   "Draws the seed of each payload",
+                   StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=4294967295.0]"),
+                   MakePointerAccessor (&PayloadGenerator::m_rng),
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("PoolSize",
+                   "Number of payloads built on first use and then sent in turn, so "
+                   "payloads repeat every PoolSize packets, which a compressor with a "
+                   "history spanning them exploits; 0 builds each payload when it is sent",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PayloadGenerator::m_poolSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+PayloadGenerator::PayloadGenerator ()
+  : m_poolSize (0),
+    m_poolRequest (0),
+    m_poolNext (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PayloadGenerator::~PayloadGenerator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PayloadGenerator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_rng = 0;
+  m_pool.clear ();
+  Object::DoDispose ();
+}
+
+Ptr<Packet>
+PayloadGenerator::CreatePacket (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  if (m_poolSize > 0)
+    {
+      if (m_pool.empty () || m_poolRequest != size)
+        {
+          NS_LOG_LOGIC ("Building " << m_poolSize << " payloads for size " << size);
+          m_pool.assign (m_poolSize, std::vector<uint8_t> ());
+          for (uint32_t i = 0; i < m_poolSize; i++)
+            {
+              m_pool[i].resize (GetPayloadSize (size));
+              if (!m_pool[i].empty ())
+                {
+                  Generate (&m_pool[i][0], m_pool[i].size (), NextSeed ());
+                }
+            }
+          m_poolRequest = size;
+          m_poolNext = 0;
+        }
+      const std::vector<uint8_t> &payload = m_pool[m_poolNext];
+      m_poolNext = (m_poolNext + 1) % m_poolSize;
+      if (payload.empty ())
+        {
+          return Create<Packet> ();
+        }
+      return Create<Packet> (&payload[0], payload.size ());
+    }
+
+  size = GetPayloadSize (size);
+  if (size == 0)
+    {
+      return Create<Packet> ();
+    }
+  std::vector<uint8_t> &payload = PayloadScratch ();
+  payload.resize (size);
+  Generate (&payload[0], size, NextSeed ());
+  return Create<Packet> (&payload[0], size);
+}
+
+int64_t
+PayloadGenerator::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rng->SetStream (stream);
+  return 1;
+}
+
+uint32_t
+PayloadGenerator::GetPayloadSize (uint32_t size)
+{
+  return size;
+}
+
+uint64_t
+PayloadGenerator::NextSeed (void)
+{
+  return (uint64_t (m_rng->GetInteger ()) << 32) | m_rng->GetInteger ();
+}
+
+TypeId
+RandomPayloadGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RandomPayloadGenerator")
+    .SetParent<PayloadGenerator> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<RandomPayloadGenerator> ()
+  ;
+  return tid;
+}
+
+void
+RandomPayloadGenerator::Generate (uint8_t *buffer, uint32_t size, uint64_t seed)
+{
+  FillRandomPayload (buffer, size, seed);
+}
+
+TypeId
+EntropyPayloadGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EntropyPayloadGenerator")
+    .SetParent<PayloadGenerator> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<EntropyPayloadGenerator> ()
+    .AddAttribute ("Entropy",
+                   "Shannon entropy per payload byte, in bits",
+                   DoubleValue (8.0),
+                   MakeDoubleAccessor (&EntropyPayloadGenerator::SetEntropy,
+                                       &EntropyPayloadGenerator::GetEntropy),
+                   MakeDoubleChecker<double> (0.0, 8.0))
+  ;
+  return tid;
+}
+
+EntropyPayloadGenerator::EntropyPayloadGenerator ()
+  : m_entropy (8.0),
+    m_zeroBelow (1ULL << 24)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EntropyPayloadGenerator::SetEntropy (double entropy)
+{
+  NS_LOG_FUNCTION (this << entropy);
+  m_entropy = entropy;
+  // The entropy falls from 8 bits at p = 1/256 to 0 at p = 1
+  double low = 1.0 / 256;
+  double high = 1.0;
+  for (int i = 0; i < 64; i++)
+    {
+      double p = (low + high) / 2;
+      if (ZeroBiasedEntropy (p) > entropy)
+        {
+          low = p;
+        }
+      else
+        {
+          high = p;
+        }
+    }
+  m_zeroBelow = static_cast<uint64_t> (std::ldexp ((low + high) / 2, 32));
+  NS_LOG_LOGIC ("P(0) = " << (low + high) / 2);
+}
+
+double
+EntropyPayloadGenerator::GetEntropy (void) const
+{
+  return m_entropy;
+}
+
+void
+EntropyPayloadGenerator::Generate (uint8_t *buffer, uint32_t size, uint64_t seed)
+{
+  for (uint32_t i = 0; i < size; i++)
+    {
+      uint64_t z = RandomPayloadWord (seed, i);
+      buffer[i] = (z & 0xffffffff) < m_zeroBelow ? 0 : 1 + (z >> 32) % 255;
+    }
+}
+
+TypeId
+PatternPayloadGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PatternPayloadGenerator")
+    .SetParent<PayloadGenerator> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<PatternPayloadGenerator> ()
+    .AddAttribute ("Period",
+                   "Length in bytes of the random pattern each payload repeats",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&PatternPayloadGenerator::m_period),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+void
+PatternPayloadGenerator::Generate (uint8_t *buffer, uint32_t size, uint64_t seed)
+{
+  uint32_t period = std::min (m_period, size);
+  FillRandomPayload (buffer, period, seed);
+  for (uint32_t i = period; i < size; i++)
+    {
+      buffer[i] = buffer[i - period];
+    }
+}
+
+TypeId
+MarkovPayloadGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MarkovPayloadGenerator")
+    .SetParent<PayloadGenerator> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<MarkovPayloadGenerator> ()
+    .AddAttribute ("TrainingFile",
+                   "Text the chain is trained on; a built-in English sample if empty",
+                   StringValue (""),
+                   MakeStringAccessor (&MarkovPayloadGenerator::m_trainingFile),
+                   MakeStringChecker ())
+    .AddAttribute ("Order",
+                   "Number of preceding characters each character depends on",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&MarkovPayloadGenerator::m_order),
+                   MakeUintegerChecker<uint32_t> (1, 16))
+  ;
+  return tid;
+}
+
+MarkovPayloadGenerator::MarkovPayloadGenerator ()
+  : m_order (3)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MarkovPayloadGenerator::Train (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_trainingFile.empty ())
+    {
+      m_text = MARKOV_SAMPLE_TEXT;
+    }
+  else
+    {
+      std::ifstream file (m_trainingFile.c_str (), std::ios::in | std::ios::binary);
+      NS_ABORT_MSG_UNLESS (file.good (), "MarkovPayloadGenerator: unable to open " << m_trainingFile);
+      m_text.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+    }
+  NS_ABORT_MSG_IF (m_text.size () <= m_order, "MarkovPayloadGenerator: training text shorter than Order");
+  for (uint32_t i = 0; i + m_order < m_text.size (); i++)
+    {
+      m_followers[m_text.substr (i, m_order)].push_back (m_text[i + m_order]);
+    }
+  NS_LOG_INFO (m_followers.size () << " contexts in " << m_text.size () << " training bytes");
+}
+
+void
+MarkovPayloadGenerator::Generate (uint8_t *buffer, uint32_t size, uint64_t seed)
+{
+  if (m_followers.empty ())
+    {
+      Train ();
+    }
+  uint64_t word = 0;
+  std::string context;
+  std::unordered_map<std::string, std::string>::const_iterator it = m_followers.end ();
+  for (uint32_t i = 0; i < size; i++)
+    {
+      if (it == m_followers.end ())
+        {
+          // Start, or the context only occurs at the end of the text
+          uint64_t start = RandomPayloadWord (seed, word++) % (m_text.size () - m_order);
+          context = m_text.substr (start, m_order);
+          it = m_followers.find (context);
+        }
+      const std::string &followers = it->second;
+      char c = followers[RandomPayloadWord (seed, word++) % followers.size ()];
+      buffer[i] = c;
+      context.erase (0, 1);
+      context.push_back (c);
+      it = m_followers.find (context);
+    }
+}
+
+TypeId
+ImixPayloadGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ImixPayloadGenerator")
+    .SetParent<PayloadGenerator> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<ImixPayloadGenerator> ()
+    .AddAttribute ("Sizes",
+                   "Payload sizes and their weights, as size:weight pairs separated by commas",
+                   StringValue ("40:7,576:4,1500:1"),
+                   MakeStringAccessor (&ImixPayloadGenerator::SetSizes,
+                                       &ImixPayloadGenerator::GetSizes),
+                   MakeStringChecker ())
+    .AddAttribute ("Content",
+                   "Generator of the payload bytes",
+                   StringValue ("ns3::RandomPayloadGenerator"),
+                   MakePointerAccessor (&ImixPayloadGenerator::m_content),
+                   MakePointerChecker<PayloadGenerator> ())
+  ;
+  return tid;
+}
+
+void
+ImixPayloadGenerator::SetSizes (std::string sizes)
+{
+  NS_LOG_FUNCTION (this << sizes);
+  m_sizesString = sizes;
+  m_sizes.clear ();
+  m_cumulative.clear ();
+  std::istringstream iss (sizes);
+  std::string pair;
+  double total = 0;
+  while (std::getline (iss, pair, ','))
+    {
+      uint32_t size;
+      double weight;
+      char colon;
+      std::istringstream pairStream (pair);
+      pairStream >> size >> colon >> weight;
+      NS_ABORT_MSG_IF (pairStream.fail () || colon != ':' || weight < 0,
+                       "ImixPayloadGenerator: bad size:weight pair \"" << pair << "\"");
+      total += weight;
+      m_sizes.push_back (size);
+      m_cumulative.push_back (total);
+    }
+  NS_ABORT_MSG_IF (total <= 0, "ImixPayloadGenerator: no size with a positive weight in \"" << sizes << "\"");
+}
+
+std::string
+ImixPayloadGenerator::GetSizes (void) const
+{
+  return m_sizesString;
+}
+
+int64_t
+ImixPayloadGenerator::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  int64_t assigned = PayloadGenerator::AssignStreams (stream);
+  return assigned + m_content->AssignStreams (stream + assigned);
+}
+
+uint32_t
+ImixPayloadGenerator::GetPayloadSize (uint32_t)
+{
+  // The mix replaces the size the application asks for.  53 random bits give a uniform double in [0, 1)
+  double u = std::ldexp (static_cast<double> (NextSeed () >> 11), -53) * m_cumulative.back ();
+  std::vector<double>::const_iterator it = std::upper_bound (m_cumulative.begin (), m_cumulative.end (), u);
+  return m_sizes[std::min<size_t> (it - m_cumulative.begin (), m_sizes.size () - 1)];
+}
+
+void
+ImixPayloadGenerator::Generate (uint8_t *buffer, uint32_t size, uint64_t seed)
+{
+  m_content->Generate (buffer, size, seed);
+}
+
+void
+ImixPayloadGenerator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_content = 0;
+  PayloadGenerator::DoDispose ();
+}
+
+} // namespace ns3
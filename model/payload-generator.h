@@ -0,0 +1,268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PAYLOAD_GENERATOR_H
+#define PAYLOAD_GENERATOR_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup udpapp
+ * \brief Base class of the payload generators of UdpAppClient
+ *
+ * A generator picks the size of each payload and writes its bytes.  Every
+ * payload is built from a 64-bit seed drawn from the Rng attribute, so runs
+ * are reproducible from RngRun and AssignStreams.  Payloads are built in a
+ * buffer shared by all generators, since the packet copies it.
+ *
+ * With PoolSize above 0, the generator builds that many payloads on first
+ * use and hands them out in turn, so generating them, which can cost more
+ * than the rest of the send path, leaves the send path.  The pool saves
+ * the generation only: each packet still gets its own copy of the bytes,
+ * and its own uid.  Sharing a pooled packet through Packet::Copy would not
+ * avoid the copy, which the first header added to a shared buffer makes,
+ * and the copies would share one uid.
+ *
+ * Payloads then repeat every PoolSize packets.  A compressor keeping a
+ * history across packets (the History attribute of PointToPointNetDevice)
+ * finds the repeats when PoolSize payloads fit in its 32 KiB window, and
+ * compresses far better than with fresh payloads; packet by packet
+ * compression is not affected.
+ */
+class PayloadGenerator : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PayloadGenerator ();
+  virtual ~PayloadGenerator ();
+
+  /**
+   * \brief Create a packet with a new payload
+   * \param size the payload size the application asks for
+   * \return the packet
+   */
+  Ptr<Packet> CreatePacket (uint32_t size);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  virtual int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Choose the size of the next payload
+   * \param size the payload size the application asks for
+   * \return the size to generate; by default size
+   */
+  virtual uint32_t GetPayloadSize (uint32_t size);
+
+  /**
+   * \brief Write a payload
+   * \param buffer where to write
+   * \param size the number of bytes to write
+   * \param seed the seed of this payload
+   */
+  virtual void Generate (uint8_t *buffer, uint32_t size, uint64_t seed) = 0;
+
+protected:
+  virtual void DoDispose (void);
+
+  /**
+   * \return a new 64-bit seed from the Rng attribute
+   */
+  uint64_t NextSeed (void);
+
+private:
+  Ptr<RandomVariableStream> m_rng; //!< Draws the seed of each payload
+  uint32_t m_poolSize;             //!< Payloads to build ahead, or 0
+  uint32_t m_poolRequest;          //!< Size asked for when m_pool was built
+  uint32_t m_poolNext;             //!< Next payload of m_pool to hand out
+  std::vector<std::vector<uint8_t> > m_pool; //!< Payloads built ahead
+};
+
+/**
+ * \ingroup udpapp
+ * \brief Uniformly random payloads, which do not compress
+ *
+ * \see FillRandomPayload
+ */
+class RandomPayloadGenerator : public PayloadGenerator
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual void Generate (uint8_t *buffer, uint32_t size, uint64_t seed);
+};
+
+/**
+ * \ingroup udpapp
+ * \brief Payloads of a given Shannon entropy per byte
+ *
+ * Each byte is 0 with probability p, and otherwise uniform over 1-255; p is
+ * solved so that the byte distribution has Entropy bits.  Entropy 8 gives
+ * uniformly random bytes and 0 gives zeros.  A short payload's empirical
+ * entropy is somewhat below the target, as with any finite sample.
+ */
+class EntropyPayloadGenerator : public PayloadGenerator
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  EntropyPayloadGenerator ();
+
+  /**
+   * \param entropy the entropy per byte, in bits, from 0 to 8
+   */
+  void SetEntropy (double entropy);
+
+  /**
+   * \return the entropy per byte, in bits
+   */
+  double GetEntropy (void) const;
+
+  virtual void Generate (uint8_t *buffer, uint32_t size, uint64_t seed);
+
+private:
+  double m_entropy;      //!< Target entropy per byte
+  uint64_t m_zeroBelow;  //!< A byte is 0 when a 32-bit draw is below this
+};
+
+/**
+ * \ingroup udpapp
+ * \brief Payloads repeating a random pattern
+ *
+ * Each payload repeats its own random Period byte pattern, so deflate
+ * finds matches once Period is within its 32 KiB window.
+ */
+class PatternPayloadGenerator : public PayloadGenerator
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual void Generate (uint8_t *buffer, uint32_t size, uint64_t seed);
+
+private:
+  uint32_t m_period; //!< Length of the repeated pattern
+};
+
+/**
+ * \ingroup udpapp
+ * \brief Text payloads from a character Markov chain
+ *
+ * The chain is trained on TrainingFile, or on a built-in English sample
+ * when it is empty.  Each character is drawn given the Order previous
+ * ones, as they followed each other in the training text, so the payloads
+ * look like, and compress like, text of that kind.
+ */
+class MarkovPayloadGenerator : public PayloadGenerator
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MarkovPayloadGenerator ();
+
+  virtual void Generate (uint8_t *buffer, uint32_t size, uint64_t seed);
+
+private:
+  /// Read the training text and build the chain
+  void Train (void);
+
+  std::string m_trainingFile; //!< File to train on, or empty
+  uint32_t m_order;           //!< Characters of context
+  std::string m_text;         //!< The training text
+  /// The characters that follow each context in the training text
+  std::unordered_map<std::string, std::string> m_followers;
+};
+
+/**
+ * \ingroup udpapp
+ * \brief Payload sizes from an IMIX-style mix
+ *
+ * Sizes is a list of size:weight pairs, e.g. the simple IMIX
+ * "40:7,576:4,1500:1"; each payload gets one of the sizes with a
+ * probability proportional to its weight, and its bytes from Content.
+ * The size asked for by the application is ignored.
+ */
+class ImixPayloadGenerator : public PayloadGenerator
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param sizes the mix, as size:weight pairs separated by commas
+   */
+  void SetSizes (std::string sizes);
+
+  /**
+   * \return the mix, as size:weight pairs separated by commas
+   */
+  std::string GetSizes (void) const;
+
+  virtual int64_t AssignStreams (int64_t stream);
+  virtual uint32_t GetPayloadSize (uint32_t size);
+  virtual void Generate (uint8_t *buffer, uint32_t size, uint64_t seed);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  std::string m_sizesString;         //!< The mix as set
+  std::vector<uint32_t> m_sizes;     //!< Sizes of the mix
+  std::vector<double> m_cumulative;  //!< Cumulative weights of the sizes
+  Ptr<PayloadGenerator> m_content;   //!< Writes the bytes
+};
+
+} // namespace ns3
+
+#endif /* PAYLOAD_GENERATOR_H */
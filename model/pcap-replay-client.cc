@@ -0,0 +1,522 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/trace-helper.h"
+#include "ns3/trace-source-accessor.h"
+#include "point-to-point-compression-header.h"
+#include "pcap-replay-client.h"
+#include "send-time-tag.h"
+extern "C"{
+#include "zlib.h"
+}
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayClient");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplayClient);
+
+TypeId
+PcapReplayClient::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplayClient")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<PcapReplayClient> ()
+    .AddAttribute ("File",
+                   "The pcap file whose UDP datagrams are replayed",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplayClient::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("TimeScale",
+                   "Factor applied to the gaps between the datagrams of the capture; "
+                   "0.5 replays it twice as fast, 0 all at once",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&PcapReplayClient::m_timeScale),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MaxPackets",
+                   "The maximum number of datagrams to send, or 0 for the whole capture",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapReplayClient::m_count),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RemoteAddress",
+                   "The destination Address of the outbound packets",
+                   AddressValue (),
+                   MakeAddressAccessor (&PcapReplayClient::m_peerAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("RemotePort",
+                   "The destination port of the outbound packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapReplayClient::m_peerPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddTraceSource ("Tx", "A new packet is created and is sent",
+                     MakeTraceSourceAccessor (&PcapReplayClient::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PcapReplayClient::PcapReplayClient ()
+  : m_dataLinkType (0),
+    m_nanoseconds (false),
+    m_stream (0),
+    m_streamSynced (false),
+    m_streamSequence (0),
+    m_firstCapture (0),
+    m_nextCapture (0),
+    m_sent (0),
+    m_skipped (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplayClient::~PcapReplayClient ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PcapReplayClient::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_stream != 0)
+    {
+      inflateEnd (m_stream);
+      delete m_stream;
+      m_stream = 0;
+    }
+  m_socket = 0;
+  Application::DoDispose ();
+}
+
+void
+PcapReplayClient::SetRemote (Address ip, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << ip << port);
+  m_peerAddress = ip;
+  m_peerPort = port;
+}
+
+uint32_t
+PcapReplayClient::GetSent (void) const
+{
+  return m_sent;
+}
+
+uint32_t
+PcapReplayClient::GetSkipped (void) const
+{
+  return m_skipped;
+}
+
+void
+PcapReplayClient::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_filename.empty (), "PcapReplayClient: no File to replay");
+
+  if (m_socket == 0)
+    {
+      Address peer = m_peerAddress;
+      if (Ipv4Address::IsMatchingType (m_peerAddress))
+        {
+          peer = InetSocketAddress (Ipv4Address::ConvertFrom (m_peerAddress), m_peerPort);
+        }
+      else if (Ipv6Address::IsMatchingType (m_peerAddress))
+        {
+          peer = Inet6SocketAddress (Ipv6Address::ConvertFrom (m_peerAddress), m_peerPort);
+        }
+      bool v6 = Inet6SocketAddress::IsMatchingType (peer);
+      NS_ABORT_MSG_UNLESS (v6 || InetSocketAddress::IsMatchingType (peer),
+                           "Incompatible address type: " << m_peerAddress);
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      if ((v6 ? m_socket->Bind6 () : m_socket->Bind ()) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      m_socket->Connect (peer);
+    }
+  m_socket->SetRecvCallback (MakeCallback (&PcapReplayClient::HandleRead, this));
+
+  m_pcap.Close ();
+  m_pcap.Clear ();
+  m_pcap.Open (m_filename, std::ios::in);
+  NS_ABORT_MSG_IF (m_pcap.Fail (), "PcapReplayClient: Unable to open " << m_filename);
+  m_dataLinkType = m_pcap.GetDataLinkType ();
+  m_nanoseconds = m_pcap.IsNanoSecMode ();
+  // Records are read into one buffer, whatever the size of the file
+  m_frame.resize (std::max<uint32_t> (m_pcap.GetSnapLen (), 65535));
+  m_streamSynced = false;
+
+  m_start = Simulator::Now ();
+  if (ReadNext ())
+    {
+      m_firstCapture = m_nextCapture;
+      m_sendEvent = Simulator::ScheduleNow (&PcapReplayClient::Send, this);
+    }
+  else
+    {
+      NS_LOG_WARN ("No UDP datagram in " << m_filename);
+    }
+}
+
+void
+PcapReplayClient::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+  m_pcap.Close ();
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_socket = 0;
+    }
+}
+
+bool
+PcapReplayClient::ReadNext (void)
+{
+  while (true)
+    {
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      m_pcap.Read (&m_frame[0], m_frame.size (), tsSec, tsUsec, inclLen, origLen, readLen);
+      if (m_pcap.Fail ())
+        {
+          return false;
+        }
+
+      const uint8_t *frame = &m_frame[0];
+      uint32_t size = readLen;
+      if (m_dataLinkType == PcapHelper::DLT_PPP)
+        {
+          uint32_t pos = (size >= 2 && frame[0] == 0xff && frame[1] == 0x03) ? 2 : 0;
+          if (size >= pos + 2 && ((frame[pos] << 8) | frame[pos + 1]) == 0x4021)
+            {
+              if (!Inflate (frame + pos + 2, size - pos - 2))
+                {
+                  NS_LOG_LOGIC ("Skipping a compressed frame that cannot be inflated");
+                  m_skipped++;
+                  continue;
+                }
+              frame = &m_inflated[0];
+              size = m_inflated.size ();
+            }
+        }
+
+      uint32_t offset;
+      uint32_t length;
+      if (!FindUdpPayload (m_dataLinkType, frame, size, offset, length))
+        {
+          m_skipped++;
+          continue;
+        }
+      // Bytes past the snap length are not in the file; they are sent as zeros
+      uint32_t captured = std::min (length, size - offset);
+      m_payload.assign (length, 0);
+      std::copy (frame + offset, frame + offset + captured, m_payload.begin ());
+      m_nextCapture = int64_t (tsSec) * 1000000000 + int64_t (tsUsec) * (m_nanoseconds ? 1 : 1000);
+      return true;
+    }
+}
+
+bool
+PcapReplayClient::Inflate (const uint8_t *data, uint32_t size)
+{
+  m_inflated.resize (65536 + 3);
+  z_stream stream;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+
+  // Older versions of this module put a zlib stream of the IPv4 packet
+  // right after the PPP protocol
+  if (size >= 2 && (data[0] & 0x0f) == Z_DEFLATED && ((data[0] << 8) | data[1]) % 31 == 0)
+    {
+      stream.avail_in = size;
+      stream.next_in = const_cast<Bytef *> (data);
+      stream.avail_out = m_inflated.size () - 2;
+      stream.next_out = &m_inflated[2];
+      if (inflateInit (&stream) != Z_OK)
+        {
+          return false;
+        }
+      int ret = inflate (&stream, Z_FINISH);
+      inflateEnd (&stream);
+      m_inflated.resize (2 + stream.total_out);
+      m_inflated[0] = 0x00;
+      m_inflated[1] = 0x21;
+      return ret == Z_STREAM_END;
+    }
+
+  // Pad, so that a frame too short for its compression header reads zeros
+  Ptr<Packet> p = Create<Packet> (data, size);
+  CompressionHeader compression;
+  p->AddPaddingAtEnd (compression.GetSerializedSize () + 6);
+  p->RemoveHeader (compression);
+  uint32_t headerSize = compression.GetSerializedSize ();
+  if (headerSize > size)
+    {
+      return false;
+    }
+  data += headerSize;
+  size -= headerSize;
+  uint32_t originalSize = compression.GetOriginalSize ();
+
+  bool inflated;
+  if (compression.HasSequence ())
+    {
+      // Frames of a shared history only inflate after its start, in order
+      if (compression.IsReset ())
+        {
+          m_streamSynced = true;
+        }
+      else if (compression.GetSequence () != m_streamSequence)
+        {
+          m_streamSynced = false;
+        }
+      m_streamSequence = compression.GetSequence () + 1;
+      if (!m_streamSynced)
+        {
+          return false;
+        }
+      if (m_stream == 0)
+        {
+          m_stream = new z_stream ();
+          if (inflateInit2 (m_stream, -MAX_WBITS) != Z_OK)
+            {
+              delete m_stream;
+              m_stream = 0;
+              return false;
+            }
+        }
+      else if (compression.IsReset ())
+        {
+          inflateReset (m_stream);
+        }
+      m_stream->avail_in = size;
+      m_stream->next_in = const_cast<Bytef *> (data);
+      m_stream->avail_out = originalSize + 1;
+      m_stream->next_out = &m_inflated[2];
+      int ret = inflate (m_stream, Z_SYNC_FLUSH);
+      inflated = ret == Z_OK && m_stream->avail_in == 0 && m_stream->avail_out == 1;
+      m_streamSynced = inflated;
+    }
+  else
+    {
+      stream.avail_in = size;
+      stream.next_in = const_cast<Bytef *> (data);
+      stream.avail_out = originalSize;
+      stream.next_out = &m_inflated[2];
+      if (inflateInit (&stream) != Z_OK)
+        {
+          return false;
+        }
+      int ret = inflate (&stream, Z_FINISH);
+      inflateEnd (&stream);
+      inflated = ret == Z_STREAM_END && stream.total_out == originalSize;
+    }
+  m_inflated.resize (2 + originalSize);
+  m_inflated[0] = compression.GetProtocol () >> 8;
+  m_inflated[1] = compression.GetProtocol () & 0xff;
+  return inflated;
+}
+
+bool
+PcapReplayClient::FindUdpPayload (uint32_t dataLinkType, const uint8_t *frame, uint32_t size,
+                                  uint32_t &offset, uint32_t &length)
+{
+  // Find the IP packet; type is its ethertype, or 0 to tell from the version
+  uint32_t pos = 0;
+  uint16_t type = 0;
+  switch (dataLinkType)
+    {
+    case PcapHelper::DLT_NULL:
+      {
+        if (size < 4)
+          {
+            return false;
+          }
+        // The address family, in the byte order of the capturing host
+        uint8_t family = frame[0] ? frame[0] : frame[3];
+        type = family == 2 ? 0x0800 : (family == 24 || family == 28 || family == 30) ? 0x86dd : 1;
+        pos = 4;
+        break;
+      }
+    case PcapHelper::DLT_EN10MB:
+      pos = 12;
+      do
+        {
+          if (size < pos + 2)
+            {
+              return false;
+            }
+          type = (frame[pos] << 8) | frame[pos + 1];
+          pos += (type == 0x8100 || type == 0x88a8) ? 4 : 2;
+        }
+      while (type == 0x8100 || type == 0x88a8);
+      break;
+    case PcapHelper::DLT_PPP:
+      {
+        pos = (size >= 2 && frame[0] == 0xff && frame[1] == 0x03) ? 2 : 0;
+        if (size < pos + 2)
+          {
+            return false;
+          }
+        uint16_t protocol = (frame[pos] << 8) | frame[pos + 1];
+        type = protocol == 0x0021 ? 0x0800 : protocol == 0x0057 ? 0x86dd : 1;
+        pos += 2;
+        break;
+      }
+    case PcapHelper::DLT_RAW:
+      break;
+    case PcapHelper::DLT_LINUX_SLL:
+      if (size < 16)
+        {
+          return false;
+        }
+      type = (frame[14] << 8) | frame[15];
+      pos = 16;
+      break;
+    default:
+      return false;
+    }
+  if (size < pos + 1)
+    {
+      return false;
+    }
+  uint8_t version = frame[pos] >> 4;
+  if (type == 0)
+    {
+      type = version == 4 ? 0x0800 : version == 6 ? 0x86dd : 1;
+    }
+
+  uint32_t udp;
+  if (type == 0x0800 && version == 4)
+    {
+      if (size < pos + 20)
+        {
+          return false;
+        }
+      uint16_t fragment = ((frame[pos + 6] & 0x1f) << 8) | frame[pos + 7];
+      if (frame[pos + 9] != 17 || fragment != 0)
+        {
+          return false;
+        }
+      udp = pos + (frame[pos] & 0x0f) * 4;
+    }
+  else if (type == 0x86dd && version == 6)
+    {
+      udp = pos + 40;
+      if (size < udp)
+        {
+          return false;
+        }
+      uint8_t next = frame[pos + 6];
+      // Hop-by-hop, routing and destination options headers
+      while (next == 0 || next == 43 || next == 60)
+        {
+          if (size < udp + 2)
+            {
+              return false;
+            }
+          next = frame[udp];
+          udp += (frame[udp + 1] + 1) * 8;
+        }
+      if (next == 44)
+        {
+          if (size < udp + 8 || (((frame[udp + 2] << 8) | frame[udp + 3]) & 0xfff8) != 0)
+            {
+              return false;
+            }
+          next = frame[udp];
+          udp += 8;
+        }
+      if (next != 17)
+        {
+          return false;
+        }
+    }
+  else
+    {
+      return false;
+    }
+
+  if (size < udp + 8)
+    {
+      return false;
+    }
+  uint16_t udpLength = (frame[udp + 4] << 8) | frame[udp + 5];
+  if (udpLength < 8)
+    {
+      return false;
+    }
+  offset = udp + 8;
+  length = udpLength - 8;
+  return true;
+}
+
+void
+PcapReplayClient::Send (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> p = Create<Packet> (m_payload.data (), m_payload.size ());
+  p->AddPacketTag (SendTimeTag (Simulator::Now ()));
+  m_txTrace (p);
+  m_socket->Send (p);
+  m_sent++;
+  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client replayed " << p->GetSize () << " bytes");
+
+  if ((m_count == 0 || m_sent < m_count) && ReadNext ())
+    {
+      // Times are taken from the first datagram, so rounding does not add up;
+      // one captured before the previous goes at once
+      Time at = m_start + NanoSeconds (int64_t ((m_nextCapture - m_firstCapture) * m_timeScale));
+      m_sendEvent = Simulator::Schedule (Max (at - Simulator::Now (), Seconds (0)),
+                                         &PcapReplayClient::Send, this);
+      return;
+    }
+  NS_LOG_INFO ("Replayed " << m_sent << " datagrams of " << m_filename
+               << ", skipped " << m_skipped << " records");
+}
+
+void
+PcapReplayClient::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      NS_LOG_LOGIC ("Received " << packet->GetSize () << " bytes");
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_CLIENT_H
+#define PCAP_REPLAY_CLIENT_H
+
+#include <string>
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/pcap-file.h"
+#include "ns3/traced-callback.h"
+
+struct z_stream_s;
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup udpapp
+ * \brief A UDP client replaying the payloads and timing of a pcap file
+ *
+ * The client sends the payload of every UDP datagram of File to
+ * RemoteAddress and RemotePort, with the gaps between their capture times
+ * multiplied by TimeScale; the first one goes when the application starts.
+ * The file is read one record ahead, so a capture of any size is replayed
+ * in constant memory.
+ *
+ * Ethernet, raw IP, Linux cooked, BSD loopback and PPP captures are
+ * understood.  Compressed PPP frames (protocol 0x4021) of this module are
+ * inflated first, so the pcap files of its point-to-point devices, and
+ * Compression.pcap, can be replayed.  A payload cut short by the snap
+ * length is completed with zeros up to its size in the UDP header.  Other
+ * records, fragments after the first and frames continuing a compression
+ * history whose start was not captured are skipped.
+ */
+class PcapReplayClient : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapReplayClient ();
+  virtual ~PcapReplayClient ();
+
+  /**
+   * \brief set the remote address and port
+   * \param ip remote IP address
+   * \param port remote port
+   */
+  void SetRemote (Address ip, uint16_t port);
+
+  /**
+   * \return the number of datagrams sent
+   */
+  uint32_t GetSent (void) const;
+
+  /**
+   * \return the number of records skipped
+   */
+  uint32_t GetSkipped (void) const;
+
+  /**
+   * \brief Find the UDP payload of a captured frame
+   * \param dataLinkType the data link type of the capture, e.g. PcapHelper::DLT_EN10MB
+   * \param frame the captured bytes
+   * \param size the number of captured bytes
+   * \param [out] offset where the payload starts in frame
+   * \param [out] length the size of the payload, from the UDP header; the
+   *        capture may hold fewer bytes
+   * \return false if the frame is not the first fragment of a UDP datagram
+   */
+  static bool FindUdpPayload (uint32_t dataLinkType, const uint8_t *frame, uint32_t size,
+                              uint32_t &offset, uint32_t &length);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Read records until the next UDP datagram
+   * \return false at the end of the file
+   */
+  bool ReadNext (void);
+
+  /**
+   * \brief Inflate a compressed PPP frame into m_inflated
+   *
+   * m_inflated gets the PPP protocol of the payload, then the payload.
+   *
+   * \param data the bytes after the PPP protocol
+   * \param size their number
+   * \return false if the frame cannot be inflated
+   */
+  bool Inflate (const uint8_t *data, uint32_t size);
+
+  /**
+   * \brief Send the datagram read ahead, and schedule the next one
+   */
+  void Send (void);
+
+  /**
+   * \brief Handle a packet reception.
+   *
+   * This function is called by lower layers.
+   *
+   * \param socket the socket the packet was received to.
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  std::string m_filename;   //!< The capture to replay
+  double m_timeScale;       //!< Factor applied to the capture's gaps
+  uint32_t m_count;         //!< Largest number of datagrams to send, or 0
+  Address m_peerAddress;    //!< Remote peer address
+  uint16_t m_peerPort;      //!< Remote peer port
+
+  PcapFile m_pcap;                  //!< The capture, read one record at a time
+  uint32_t m_dataLinkType;          //!< Data link type of the capture
+  bool m_nanoseconds;               //!< Timestamps are in nanoseconds
+  std::vector<uint8_t> m_frame;     //!< The record being read
+  std::vector<uint8_t> m_inflated;  //!< The frame, inflated
+  struct z_stream_s *m_stream;      //!< Inflate state of stateful compressed frames
+  bool m_streamSynced;              //!< m_stream has seen the start of its history
+  uint16_t m_streamSequence;        //!< Sequence number of the next stateful frame
+  std::vector<uint8_t> m_payload;   //!< Payload of the next datagram
+  int64_t m_firstCapture;           //!< Capture time of the first datagram, in ns
+  int64_t m_nextCapture;            //!< Capture time of the next datagram, in ns
+  Time m_start;                     //!< When the replay started
+  uint32_t m_sent;                  //!< Datagrams sent
+  uint32_t m_skipped;               //!< Records skipped
+
+  Ptr<Socket> m_socket;   //!< Socket
+  EventId m_sendEvent;    //!< Event to send the next datagram
+
+  /// Callbacks for tracing the packet Tx events
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_CLIENT_H */
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "point-to-point-compression-config.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressionConfig");
+
+/**
+ * \ingroup point-to-point
+ * Path of the JSON file read by CompressionConfig::Get ().
+ */
+static GlobalValue g_compressionConfigPath =
+  GlobalValue ("CompressionConfigPath",
+               "The compression link config file, parsed once per process",
+               StringValue ("./config.json"),
+               MakeStringChecker ());
+
+/**
+ * \ingroup point-to-point
+ * Inline JSON document; if non-empty it is used instead of the file.
+ */
+static GlobalValue g_compressionConfigJson =
+  GlobalValue ("CompressionConfigJson",
+               "An inline compression link config, overrides CompressionConfigPath",
+               StringValue (""),
+               MakeStringChecker ());
+
+/**
+ * \brief Convert a "0x0021" style string to a PPP protocol number.
+ * \param s the string to convert
+ * \return the protocol number; aborts if it is not a supported protocol
+ */
+static uint16_t
+ParsePppProtocol (const std::string &s)
+{
+  std::istringstream buffer (s);
+  uint32_t value = 0;
+  buffer >> std::hex >> value;
+  if (buffer.fail ())
+    {
+      NS_FATAL_ERROR ("protocolsToCompress: \"" << s << "\" is not a hex protocol number");
+    }
+  switch (value)
+    {
+    case 0x0021:   //IPv4
+    case 0x0057:   //IPv6
+      return static_cast<uint16_t> (value);
+    default:
+      NS_FATAL_ERROR ("protocolsToCompress: PPP protocol " << s << " cannot be compressed");
+    }
+  return 0;
+}
+
+const CompressionConfig &
+CompressionConfig::Get (void)
+{
+  static CompressionConfig *config = 0;
+  if (config == 0)
+    {
+      config = new CompressionConfig ();
+    }
+  return *config;
+}
+
+CompressionConfig::CompressionConfig ()
+{
+  NS_LOG_FUNCTION (this);
+  StringValue inlineJson;
+  g_compressionConfigJson.GetValue (inlineJson);
+  if (!inlineJson.Get ().empty ())
+    {
+      m_origin = "<inline>";
+      Parse (inlineJson.Get ());
+      return;
+    }
+
+  StringValue path;
+  g_compressionConfigPath.GetValue (path);
+  m_origin = path.Get ();
+  std::ifstream jsonIn (m_origin.c_str ());
+  if (!jsonIn.good ())
+    {
+      NS_FATAL_ERROR ("Unable to open compression config " << m_origin);
+    }
+  std::ostringstream text;
+  text << jsonIn.rdbuf ();
+  Parse (text.str ());
+}
+
+void
+CompressionConfig::Parse (const std::string &text)
+{
+  NS_LOG_FUNCTION (this);
+  json j;
+  try
+    {
+      j = json::parse (text);
+    }
+  catch (json::exception &e)
+    {
+      NS_FATAL_ERROR ("Malformed compression config " << m_origin << ": " << e.what ());
+    }
+
+  if (!j.is_object () || !j.count ("protocolsToCompress"))
+    {
+      NS_FATAL_ERROR ("Compression config " << m_origin << " has no protocolsToCompress");
+    }
+  const json &protocols = j["protocolsToCompress"];
+  if (protocols.is_string ())
+    {
+      m_protocols.push_back (ParsePppProtocol (protocols.get<std::string> ()));
+    }
+  else if (protocols.is_array ())
+    {
+      for (json::const_iterator it = protocols.begin (); it != protocols.end (); ++it)
+        {
+          if (!it->is_string ())
+            {
+              NS_FATAL_ERROR ("protocolsToCompress entries must be hex strings");
+            }
+          m_protocols.push_back (ParsePppProtocol (it->get<std::string> ()));
+        }
+    }
+  else
+    {
+      NS_FATAL_ERROR ("protocolsToCompress must be a string or an array of strings");
+    }
+
+  NS_LOG_INFO ("Loaded compression config from " << m_origin << ": " << j.dump ());
+}
+
+bool
+CompressionConfig::IsCompressed (uint16_t pppProtocol) const
+{
+  return std::find (m_protocols.begin (), m_protocols.end (), pppProtocol) != m_protocols.end ();
+}
+
+const std::vector<uint16_t> &
+CompressionConfig::GetProtocols (void) const
+{
+  return m_protocols;
+}
+
+std::string
+CompressionConfig::GetOrigin (void) const
+{
+  return m_origin;
+}
+
+} // namespace ns3
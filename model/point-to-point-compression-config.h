@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_COMPRESSION_CONFIG_H
+#define POINT_TO_POINT_COMPRESSION_CONFIG_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Process-wide, read-only view of the compression link config.json
+ *
+ * The configuration is parsed and validated exactly once, the first time
+ * CompressionConfig::Get () is called, and the same instance is then shared
+ * by every PointToPointNetDevice and application in the simulation.
+ *
+ * The source of the configuration is controlled by two global values, which
+ * can be set from the command line like any other ns-3 global
+ * (e.g. \c --CompressionConfigPath=my.json):
+ *
+ *  - \c CompressionConfigJson: an inline JSON document.  If non-empty it
+ *    takes precedence over the file.
+ *  - \c CompressionConfigPath: the file to read (default \c ./config.json).
+ *
+ * Recognized keys:
+ *
+ *  - \c protocolsToCompress: a PPP protocol number written as a hex string
+ *    (e.g. "0x0021"), or an array of such strings.
+ */
+class CompressionConfig
+{
+public:
+  /**
+   * \brief Get the process-wide configuration, loading it on first use.
+   * \return the shared, immutable configuration
+   */
+  static const CompressionConfig & Get (void);
+
+  /**
+   * \param pppProtocol a PPP protocol number
+   * \return true if packets of that protocol should be compressed
+   */
+  bool IsCompressed (uint16_t pppProtocol) const;
+
+  /**
+   * \return the PPP protocol numbers listed in protocolsToCompress
+   */
+  const std::vector<uint16_t> & GetProtocols (void) const;
+
+  /**
+   * \return a human readable description of where the config came from
+   */
+  std::string GetOrigin (void) const;
+
+private:
+  CompressionConfig ();
+
+  /**
+   * \brief Parse and validate a JSON document; aborts on malformed input.
+   * \param text the JSON document
+   */
+  void Parse (const std::string &text);
+
+  std::vector<uint16_t> m_protocols; //!< PPP protocols to compress
+  std::string m_origin;              //!< File name or "<inline>"
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_COMPRESSION_CONFIG_H */
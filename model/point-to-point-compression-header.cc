@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include "ns3/log.h"
+#include "ns3/header.h"
+#include "point-to-point-compression-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressionHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (CompressionHeader);
+
+CompressionHeader::CompressionHeader ()
+  : m_flags (0),
+    m_protocol (0),
+    m_originalSize (0),
+    m_sequence (0),
+    m_crc (0)
+{
+}
+
+CompressionHeader::~CompressionHeader ()
+{
+}
+
+TypeId
+CompressionHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CompressionHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<CompressionHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+CompressionHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+CompressionHeader::Print (std::ostream &os) const
+{
+  os << "Protocol=0x" << std::hex << m_protocol << std::dec
+     << " Original size=" << m_originalSize;
+  if (HasSequence ())
+    {
+      os << " Sequence=" << m_sequence;
+    }
+  if (IsReset ())
+    {
+      os << " Reset";
+    }
+  if (HasCrc ())
+    {
+      os << " CRC32C=0x" << std::hex << m_crc << std::dec;
+    }
+}
+
+uint32_t
+CompressionHeader::GetSerializedSize (void) const
+{
+  return 5 + (HasSequence () ? 2 : 0) + (HasCrc () ? 4 : 0);
+}
+
+void
+CompressionHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteU8 (m_flags);
+  start.WriteHtonU16 (m_protocol);
+  start.WriteHtonU16 (m_originalSize);
+  if (HasSequence ())
+    {
+      start.WriteHtonU16 (m_sequence);
+    }
+  if (HasCrc ())
+    {
+      start.WriteHtonU32 (m_crc);
+    }
+}
+
+uint32_t
+CompressionHeader::Deserialize (Buffer::Iterator start)
+{
+  m_flags = start.ReadU8 ();
+  m_protocol = start.ReadNtohU16 ();
+  m_originalSize = start.ReadNtohU16 ();
+  m_sequence = HasSequence () ? start.ReadNtohU16 () : 0;
+  m_crc = HasCrc () ? start.ReadNtohU32 () : 0;
+  return GetSerializedSize ();
+}
+
+void
+CompressionHeader::SetProtocol (uint16_t protocol)
+{
+  m_protocol = protocol;
+}
+
+uint16_t
+CompressionHeader::GetProtocol (void) const
+{
+  return m_protocol;
+}
+
+void
+CompressionHeader::SetOriginalSize (uint16_t size)
+{
+  m_originalSize = size;
+}
+
+uint16_t
+CompressionHeader::GetOriginalSize (void) const
+{
+  return m_originalSize;
+}
+
+void
+CompressionHeader::SetSequence (uint16_t sequence)
+{
+  m_flags |= FLAG_SEQUENCE;
+  m_sequence = sequence;
+}
+
+bool
+CompressionHeader::HasSequence (void) const
+{
+  return (m_flags & FLAG_SEQUENCE) != 0;
+}
+
+uint16_t
+CompressionHeader::GetSequence (void) const
+{
+  return m_sequence;
+}
+
+void
+CompressionHeader::SetReset (void)
+{
+  m_flags |= FLAG_RESET;
+}
+
+bool
+CompressionHeader::IsReset (void) const
+{
+  return (m_flags & FLAG_RESET) != 0;
+}
+
+void
+CompressionHeader::SetCrc (uint32_t crc)
+{
+  m_flags |= FLAG_CRC;
+  m_crc = crc;
+}
+
+bool
+CompressionHeader::HasCrc (void) const
+{
+  return (m_flags & FLAG_CRC) != 0;
+}
+
+uint32_t
+CompressionHeader::GetCrc (void) const
+{
+  return m_crc;
+}
+
+} // namespace ns3
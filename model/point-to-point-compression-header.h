@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_COMPRESSION_HEADER_H
+#define POINT_TO_POINT_COMPRESSION_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Header carried between the PPP header and the deflate stream of a
+ * compressed (protocol 0x4021) frame.
+ *
+ * \verbatim
+ *  0        1        2        3        4        5        6        7        8        9       10
+ * +--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+
+ * | flags  | PPP protocol    | original size   | sequence (opt.) | CRC32C of original (optional)     |
+ * +--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+
+ * \endverbatim
+ *
+ * The sequence number is only present when the sequence flag is set, which
+ * marks a frame whose deflate block continues the history shared by the
+ * frames before it; the reset flag marks the frame that starts a new
+ * history.  The CRC is only present when the CRC flag is set.
+ */
+class CompressionHeader : public Header
+{
+public:
+  /**
+   * \brief Construct a compression header.
+   */
+  CompressionHeader ();
+
+  /**
+   * \brief Destroy a compression header.
+   */
+  virtual ~CompressionHeader ();
+
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Get the TypeId of the instance
+   *
+   * \return The TypeId for this instance
+   */
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+
+  /**
+   * \param protocol the PPP protocol number of the uncompressed payload
+   */
+  void SetProtocol (uint16_t protocol);
+
+  /**
+   * \return the PPP protocol number of the uncompressed payload
+   */
+  uint16_t GetProtocol (void) const;
+
+  /**
+   * \param size the size of the payload before compression
+   */
+  void SetOriginalSize (uint16_t size);
+
+  /**
+   * \return the size of the payload before compression
+   */
+  uint16_t GetOriginalSize (void) const;
+
+  /**
+   * \brief Mark the frame as part of a stateful (shared history) stream.
+   * \param sequence the per-link sequence number of the frame
+   */
+  void SetSequence (uint16_t sequence);
+
+  /**
+   * \return true if the frame is part of a stateful stream and carries a
+   * sequence number
+   */
+  bool HasSequence (void) const;
+
+  /**
+   * \return the sequence number; only valid if HasSequence ()
+   */
+  uint16_t GetSequence (void) const;
+
+  /**
+   * \brief Mark the frame as the first one after a history reset.
+   */
+  void SetReset (void);
+
+  /**
+   * \return true if the compressor reset its history before this frame
+   */
+  bool IsReset (void) const;
+
+  /**
+   * \brief Carry a CRC32C of the original payload in this header.
+   * \param crc the CRC32C of the payload before compression
+   */
+  void SetCrc (uint32_t crc);
+
+  /**
+   * \return true if the header carries a CRC32C
+   */
+  bool HasCrc (void) const;
+
+  /**
+   * \return the CRC32C of the original payload; only valid if HasCrc ()
+   */
+  uint32_t GetCrc (void) const;
+
+private:
+  /// Bits of the flags field
+  enum Flags
+  {
+    FLAG_CRC = 0x01,      //!< A CRC32C follows the original size
+    FLAG_SEQUENCE = 0x02, //!< A sequence number follows the original size
+    FLAG_RESET = 0x04     //!< The compressor history was reset before this frame
+  };
+
+  uint8_t m_flags;         //!< Flags, see Flags
+  uint16_t m_protocol;     //!< PPP protocol of the payload before compression
+  uint16_t m_originalSize; //!< Payload size before compression
+  uint16_t m_sequence;     //!< Per-link sequence number of stateful frames
+  uint32_t m_crc;          //!< CRC32C of the payload before compression
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_COMPRESSION_HEADER_H */
@@ -24,24 +24,27 @@
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/pointer.h"
+#include "ns3/enum.h"
+#include "ns3/socket.h"
 #include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
-#include <fstream>
-#include <nlohmann/json.hpp>
-#include <iomanip>
-#include <stdio.h>
-#include <string.h>
-#include <assert.h>
-#include <cstdlib>
+#include "point-to-point-compression-config.h"
+#include "point-to-point-compression-header.h"
+#include "crc32c.h"
+#include "point-to-point-tx-stage.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
 extern "C"{
 #include "zlib.h"
 }
 
-using json = nlohmann::json;
-
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PointToPointNetDevice");
@@ -80,21 +83,94 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("BurstSize",
+                   "When packets are waiting in the queue as a transmission ends, "
+                   "hand up to this many to the channel back to back with a single "
+                   "completion event.  Delivery times are unchanged, but packets "
+                   "leave the queue at the start of the burst rather than one at a "
+                   "time: the queue is shorter and drops less while the burst is on "
+                   "the wire, and a packet of a higher priority queue arriving then "
+                   "waits for the whole burst.  1 disables bursts",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_burstSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RxCoalesceWindow",
+                   "Hold received frames for up to this long and deliver them "
+                   "up the stack in one batch, modeling interrupt moderation; "
+                   "0 delivers each frame as it arrives",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&PointToPointNetDevice::m_rxCoalesceWindow),
+                   MakeTimeChecker ())
+    .AddAttribute ("RxCoalesceBudget",
+                   "Deliver a coalesced batch as soon as it holds this many frames",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_rxCoalesceBudget),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("Compression", 
                    "Should the application run compression on valid packets",
                    BooleanValue (false),
                    MakeBooleanAccessor (&PointToPointNetDevice::compressionEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("CompressOnDequeue",
+                   "Deflate packets as they leave the transmit queue instead of "
+                   "before they enter it.  Frames are then compressed in wire order, "
+                   "so History works with several compressing queues",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_compressOnDequeue),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Checksum",
+                   "Carry a CRC32C of the original payload in compressed frames",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_checksumEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("History",
+                   "Compress each frame against the history of the frames sent "
+                   "before it.  Compresses better, but a lost frame desynchronizes "
+                   "the peer until the next history reset",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_historyEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FlushInterval",
+                   "With History, reset the history every this many compressed "
+                   "frames so the peer can resynchronize; 0 disables periodic resets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_flushInterval),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ResetRequest",
+                   "With History, send a CCP Reset-Request to the peer when the "
+                   "decompressor loses sync",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_resetRequestEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ResetRequestTimeout",
+                   "Minimum time between two Reset-Requests while out of sync",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&PointToPointNetDevice::m_resetRequestTimeout),
+                   MakeTimeChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
     // of trace hooks.
     //
     .AddAttribute ("TxQueue", 
-                   "A queue to use as the transmit queue in the device.",
+                   "A queue to use as the transmit queue in the device.  With "
+                   "several transmit queues, this is the highest priority one.",
                    PointerValue (),
-                   MakePointerAccessor (&PointToPointNetDevice::m_queue),
+                   MakePointerAccessor (&PointToPointNetDevice::SetQueue,
+                                        &PointToPointNetDevice::GetQueue),
                    MakePointerChecker<Queue<Packet> > ())
+    .AddAttribute ("TxScheduler",
+                   "How the next packet is picked when there are several transmit queues",
+                   EnumValue (STRICT_PRIORITY),
+                   MakeEnumAccessor (&PointToPointNetDevice::m_txScheduler),
+                   MakeEnumChecker (STRICT_PRIORITY, "StrictPriority",
+                                    WEIGHTED_ROUND_ROBIN, "WeightedRoundRobin"))
+    .AddAttribute ("QueueClassifier",
+                   "What maps a packet to one of several transmit queues",
+                   EnumValue (CLASSIFY_DSCP),
+                   MakeEnumAccessor (&PointToPointNetDevice::m_queueClassifier),
+                   MakeEnumChecker (CLASSIFY_DSCP, "Dscp",
+                                    CLASSIFY_PRIORITY_TAG, "PriorityTag"))
 
     //
     // Trace sources at the "top" of the net device, where packets transition
@@ -169,6 +245,77 @@ PointToPointNetDevice::GetTypeId (void)
                      "dropped by the device during reception",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxDropTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("CrcDrop",
+                     "Trace source indicating a compressed frame has been "
+                     "dropped because its CRC32C did not match after inflate",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_crcDropTrace),
+                     "ns3::Packet::TracedCallback")
+
+    //
+    // Compression statistics.  The TracedValues hold running totals for the
+    // lifetime of the device, and are summarized on stdout when it is disposed.
+    //
+    .AddTraceSource ("Compress",
+                     "A packet has been compressed for transmission",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_compressTrace),
+                     "ns3::PointToPointNetDevice::CompressionTracedCallback")
+    .AddTraceSource ("Decompress",
+                     "A compressed frame has been inflated on reception",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_decompressTrace),
+                     "ns3::PointToPointNetDevice::CompressionTracedCallback")
+    .AddTraceSource ("BytesBeforeCompression",
+                     "Payload bytes handed to the compressor",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_bytesBeforeCompression),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("BytesAfterCompression",
+                     "Bytes produced by the compressor, including the compression header",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_bytesAfterCompression),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("CompressionRatio",
+                     "Running ratio of BytesBeforeCompression to BytesAfterCompression",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_compressionRatio),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("PacketsBypassed",
+                     "Packets sent uncompressed although compression is enabled",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_packetsBypassed),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("CompressNanoseconds",
+                     "Wall-clock nanoseconds spent in deflate",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_compressNanoseconds),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("DecompressNanoseconds",
+                     "Wall-clock nanoseconds spent in inflate",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_decompressNanoseconds),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("CodecErrors",
+                     "Number of deflate or inflate failures",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_codecErrors),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("DesyncDrop",
+                     "Trace source indicating a compressed frame has been "
+                     "dropped because the decompressor history is out of sync",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_desyncDropTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("RxBatch",
+                     "Receive coalescing delivered a batch of frames",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_rxBatchTrace),
+                     "ns3::PointToPointNetDevice::RxBatchTracedCallback")
+    .AddTraceSource ("RxCoalesceDelay",
+                     "How long receive coalescing held a frame",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_rxCoalesceDelayTrace),
+                     "ns3::PointToPointNetDevice::RxCoalesceDelayTracedCallback")
+    .AddTraceSource ("FramesLost",
+                     "Stateful compressed frames detected missing from the sequence",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_framesLost),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("DesyncLosses",
+                     "Compressed frames received intact but dropped while out of sync",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_desyncLosses),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("ResetRequests",
+                     "CCP Reset-Requests sent to the peer",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_resetRequestsSent),
+                     "ns3::TracedValueCallback::Uint64")
 
     //
     // Trace sources designed to simulate a packet sniffer facility (tcpdump).
@@ -185,6 +332,12 @@ PointToPointNetDevice::GetTypeId (void)
                      "attached to the device",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_promiscSnifferTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("LogicalSniffer",
+                     "Trace source giving the uncompressed packet of each frame "
+                     "a compressing device sends or receives, with the uid of "
+                     "the frame on the wire",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_logicalSnifferTrace),
+                     "ns3::PointToPointNetDevice::LogicalSnifferTracedCallback")
   ;
   return tid;
 }
@@ -198,7 +351,28 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_currentPkt (0)
 {
   NS_LOG_FUNCTION (this);
-  m_protocol = 0;
+  m_config = 0;
+  m_bytesBeforeCompression = 0;
+  m_bytesAfterCompression = 0;
+  m_compressionRatio = 1.0;
+  m_packetsBypassed = 0;
+  m_compressNanoseconds = 0;
+  m_decompressNanoseconds = 0;
+  m_codecErrors = 0;
+  m_txStream = 0;
+  m_rxStream = 0;
+  m_txSequence = 0;
+  m_rxSequence = 0;
+  // The first stateful frame always starts a fresh history
+  m_txResetPending = true;
+  m_rxSynced = false;
+  m_txSinceReset = 0;
+  m_resetRequestId = 0;
+  m_framesLost = 0;
+  m_desyncLosses = 0;
+  m_resetRequestsSent = 0;
+  m_wrrCurrent = 0;
+  m_wrrCredit = 0;
 }
 
 PointToPointNetDevice::~PointToPointNetDevice ()
@@ -230,31 +404,21 @@ PointToPointNetDevice::DoInitialize (void)
 {
   if (m_queueInterface)
     {
-      NS_ASSERT_MSG (m_queue != 0, "A Queue object has not been attached to the device");
-      // connect the traced callbacks of m_queue to the static methods provided by
-      // the NetDeviceQueue class to support flow control and dynamic queue limits.
-      // This could not be done in NotifyNewAggregate because at that time we are
-      // not guaranteed that a queue has been attached to the netdevice
-      m_queueInterface->ConnectQueueTraces (m_queue, 0);
+      NS_ASSERT_MSG (!m_txQueues.empty (), "A Queue object has not been attached to the device");
+      // Flow control and dynamic queue limits are driven by NotifyTxQueued
+      // and NotifyTxDequeued rather than by the queue traces, because byte
+      // queue limits must count the bytes that go on the wire, which are
+      // only known once a frame has been compressed
+      NS_ASSERT_MSG (m_queueInterface->GetNTxQueues () == m_txQueues.size (),
+                     "Transmit queues were added after the device was aggregated to a node");
     }
   if (compressionEnabled)
     {
-      std::cout << "Compression is enabled!\n";
+      NS_LOG_INFO ("Compression is enabled on " << this);
+      // The config file is parsed once per process and shared by all devices
+      m_config = &CompressionConfig::Get ();
     }
-// Read config file; take inputstream from the file and put it all in json j
-  std::ifstream jsonIn("./config.json");
-  json j;
-  jsonIn >> j;
-// Print the pretty json to the terminal
-  std::cout << std::setw(4) << j << std::endl;
-  std::string protocol = "";
-
-// Get the string value from protocolsToCompress and print it
-  protocol = j["protocolsToCompress"].get<std::string>();
-  std::istringstream buffer(protocol);
-  buffer >> std::hex >> m_protocol;
-  std::cout << "Protocol to compress: 0x" << std::hex << m_protocol << "\n";
-  m_protocol = PppToEther(m_protocol);
+  BuildTxPipeline ();
 
   NetDevice::DoInitialize ();
 }
@@ -271,6 +435,11 @@ PointToPointNetDevice::NotifyNewAggregate (void)
       if (ndqi != 0)
         {
           m_queueInterface = ndqi;
+          if (m_txQueues.size () > 1)
+            {
+              ndqi->SetTxQueuesN (m_txQueues.size ());
+              ndqi->SetSelectQueueCallback (MakeCallback (&PointToPointNetDevice::SelectQueue, this));
+            }
         }
     }
   NetDevice::NotifyNewAggregate ();
@@ -280,11 +449,43 @@ void
 PointToPointNetDevice::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  if (compressionEnabled && (m_bytesBeforeCompression.Get () > 0
+                             || m_decompressNanoseconds.Get () > 0
+                             || m_codecErrors.Get () > 0))
+    {
+      std::cout << "Compression statistics for node " << (m_node ? m_node->GetId () : 0)
+                << " device " << m_ifIndex << ":"
+                << " bytes before " << m_bytesBeforeCompression
+                << ", after " << m_bytesAfterCompression
+                << ", ratio " << m_compressionRatio
+                << ", bypassed " << m_packetsBypassed
+                << ", compress " << m_compressNanoseconds << " ns"
+                << ", decompress " << m_decompressNanoseconds << " ns"
+                << ", codec errors " << m_codecErrors;
+      if (m_historyEnabled)
+        {
+          std::cout << ", frames lost " << m_framesLost
+                    << ", desync losses " << m_desyncLosses
+                    << ", reset requests " << m_resetRequestsSent;
+        }
+      std::cout << "\n";
+    }
+  ReleaseStreams ();
+  m_txPipeline.clear ();
+  for (std::vector<std::pair<PointToPointTxStage::Position, Ptr<PointToPointTxStage> > >::iterator i = m_txStages.begin ();
+       i != m_txStages.end (); ++i)
+    {
+      i->second->Dispose ();
+    }
+  m_txStages.clear ();
   m_node = 0;
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
-  m_queue = 0;
+  m_burst.clear ();
+  m_rxPollEvent.Cancel ();
+  m_rxBacklog.clear ();
+  m_txQueues.clear ();
   m_queueInterface = 0;
   NetDevice::DoDispose ();
 }
@@ -347,12 +548,22 @@ PointToPointNetDevice::TransmitComplete (void)
   NS_ASSERT_MSG (m_txMachineState == BUSY, "Must be BUSY if transmitting");
   m_txMachineState = READY;
 
-  NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
-
-  m_phyTxEndTrace (m_currentPkt);
-  m_currentPkt = 0;
+  if (m_burst.empty ())
+    {
+      NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
+      m_phyTxEndTrace (m_currentPkt);
+      m_currentPkt = 0;
+    }
+  else
+    {
+      for (std::vector<Ptr<Packet> >::const_iterator i = m_burst.begin (); i != m_burst.end (); ++i)
+        {
+          m_phyTxEndTrace (*i);
+        }
+      m_burst.clear ();
+    }
 
-  Ptr<Packet> p = m_queue->Dequeue ();
+  Ptr<Packet> p = DequeueNext ();
   if (p == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
@@ -362,11 +573,330 @@ PointToPointNetDevice::TransmitComplete (void)
   //
   // Got another packet off of the queue, so start the transmit process again.
   //
-  m_snifferTrace (p);
-  m_promiscSnifferTrace (p);
+  if (!m_snifferTrace.IsEmpty () || !m_promiscSnifferTrace.IsEmpty ())
+    {
+      m_snifferTrace (p);
+      m_promiscSnifferTrace (p);
+    }
+  if (m_burstSize > 1 && !TxQueuesEmpty ())
+    {
+      TransmitBurst (p);
+      return;
+    }
   TransmitStart (p);
 }
 
+bool
+PointToPointNetDevice::TransmitBurst (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  m_txMachineState = BUSY;
+
+  m_burst.push_back (p);
+  while (m_burst.size () < m_burstSize)
+    {
+      Ptr<Packet> next = DequeueNext ();
+      if (next == 0)
+        {
+          break;
+        }
+      if (!m_snifferTrace.IsEmpty () || !m_promiscSnifferTrace.IsEmpty ())
+        {
+          m_snifferTrace (next);
+          m_promiscSnifferTrace (next);
+        }
+      m_burst.push_back (next);
+    }
+
+  std::vector<Ptr<const Packet> > packets;
+  std::vector<Time> txTimes;
+  packets.reserve (m_burst.size ());
+  txTimes.reserve (m_burst.size ());
+  Time txCompleteTime = Seconds (0);
+  for (std::vector<Ptr<Packet> >::const_iterator i = m_burst.begin (); i != m_burst.end (); ++i)
+    {
+      m_phyTxBeginTrace (*i);
+      Time txTime = m_bps.CalculateBytesTxTime ((*i)->GetSize ());
+      packets.push_back (*i);
+      txTimes.push_back (txTime);
+      txCompleteTime += txTime + m_tInterframeGap;
+    }
+
+  NS_LOG_LOGIC ("Burst of " << m_burst.size () << " packets, schedule TransmitCompleteEvent in "
+                << txCompleteTime.GetSeconds () << "sec");
+  Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitBurst (packets, txTimes, m_tInterframeGap, this);
+  if (result == false)
+    {
+      for (std::vector<Ptr<Packet> >::const_iterator i = m_burst.begin (); i != m_burst.end (); ++i)
+        {
+          m_phyTxDropTrace (*i);
+        }
+    }
+  return result;
+}
+
+bool
+PointToPointNetDevice::EnqueueAndTransmit (Ptr<Packet> packet, uint32_t queue, bool compress)
+{
+  NS_LOG_FUNCTION (this << packet << queue << compress);
+  NS_ASSERT_MSG (queue < m_txQueues.size (), "No transmit queue " << queue);
+  PendingFrame frame;
+  frame.compress = m_compressOnDequeue && compress;
+  frame.wireBytes = packet->GetSize ();
+  if (frame.compress && m_bytesAfterCompression.Get () > 0)
+    {
+      // The frame is not deflated yet; expect the ratio seen so far
+      frame.wireBytes = static_cast<uint32_t> (std::ceil (frame.wireBytes / m_compressionRatio.Get ()));
+    }
+  if (m_txQueues[queue].queue->Enqueue (packet))
+    {
+      m_txQueues[queue].pending.push_back (frame);
+      NotifyTxQueued (queue, frame.wireBytes);
+      //
+      // If the channel is ready for transition we send the packet right now.
+      // All other queues are empty then, so this is the packet just enqueued.
+      //
+      if (m_txMachineState == READY)
+        {
+          packet = DequeueNext ();
+          if (!m_snifferTrace.IsEmpty () || !m_promiscSnifferTrace.IsEmpty ())
+            {
+              m_snifferTrace (packet);
+              m_promiscSnifferTrace (packet);
+            }
+          return TransmitStart (packet);
+        }
+      return true;
+    }
+
+  // Enqueue may fail (overflow).  The upper layers should not send until
+  // there is room again, which the next dequeue wakes them for; with
+  // nothing queued there is no such dequeue, so leave the queue running.
+  if (m_queueInterface && !m_txQueues[queue].queue->IsEmpty ())
+    {
+      m_queueInterface->GetTxQueue (queue)->Stop ();
+    }
+  if (m_historyEnabled && !frame.compress)
+    {
+      // A stateful frame took a sequence number and fed the history; the
+      // peer will see the gap, so start a new history with the next frame
+      PppHeader ppp;
+      packet->PeekHeader (ppp);
+      if (ppp.GetProtocol () == 0x4021)
+        {
+          NS_LOG_LOGIC ("Compressed frame dropped before the wire, resetting the history");
+          m_txResetPending = true;
+        }
+    }
+  m_macTxDropTrace (packet);
+  return false;
+}
+
+void
+PointToPointNetDevice::NotifyTxQueued (uint32_t queue, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << queue << bytes);
+  if (m_queueInterface == 0)
+    {
+      return;
+    }
+  Ptr<NetDeviceQueue> txq = m_queueInterface->GetTxQueue (queue);
+  txq->NotifyQueuedBytes (bytes);
+
+  // Stop the upper layers if a full sized frame would no longer fit
+  if (!FullFrameFits (queue))
+    {
+      Ptr<Queue<Packet> > q = m_txQueues[queue].queue;
+      NS_LOG_DEBUG ("Transmit queue " << queue << " is being stopped ("
+                    << q->GetNPackets () << " packets and " << q->GetNBytes () << " bytes inside)");
+      txq->Stop ();
+    }
+}
+
+void
+PointToPointNetDevice::NotifyTxDequeued (uint32_t queue, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << queue << bytes);
+  if (m_queueInterface == 0)
+    {
+      return;
+    }
+  Ptr<NetDeviceQueue> txq = m_queueInterface->GetTxQueue (queue);
+  txq->NotifyTransmittedBytes (bytes);
+
+  // An empty queue wakes too, even if a full sized frame never fits, as
+  // nothing else would
+  if (FullFrameFits (queue) || m_txQueues[queue].queue->IsEmpty ())
+    {
+      txq->Wake ();
+    }
+}
+
+bool
+PointToPointNetDevice::FullFrameFits (uint32_t queue) const
+{
+  // The size a frame of the MTU adds, without building one on every call
+  Ptr<Queue<Packet> > q = m_txQueues[queue].queue;
+  QueueSize current = q->GetCurrentSize ();
+  uint32_t added = current.GetUnit () == QueueSizeUnit::PACKETS ? 1 : GetMtu ();
+  return QueueSize (current.GetUnit (), current.GetValue () + added) <= q->GetMaxSize ();
+}
+
+Ptr<Packet>
+PointToPointNetDevice::CompressFrame (Ptr<Packet> frame)
+{
+  NS_LOG_FUNCTION (this << frame);
+  PppHeader ppp;
+  frame->RemoveHeader (ppp);
+  PointToPointTxContext context;
+  context.packet = frame;
+  context.protocol = PppToEther (ppp.GetProtocol ());
+  context.pppProtocol = ppp.GetProtocol ();
+  context.compress = true;
+  context.queue = 0;
+  PayloadCompressStage (context);
+  ppp.SetProtocol (context.pppProtocol);
+  context.packet->AddHeader (ppp);
+  return context.packet;
+}
+
+Ptr<Packet>
+PointToPointNetDevice::DequeueNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t queue = NextTxQueue ();
+  if (queue == m_txQueues.size ())
+    {
+      return 0;
+    }
+  TxQueue &txQueue = m_txQueues[queue];
+  Ptr<Packet> packet = txQueue.queue->Dequeue ();
+  NS_ASSERT_MSG (packet != 0 && !txQueue.pending.empty (), "Transmit queue " << queue << " out of step");
+  PendingFrame frame = txQueue.pending.front ();
+  txQueue.pending.pop_front ();
+  if (frame.compress)
+    {
+      packet = CompressFrame (packet);
+    }
+  NotifyTxDequeued (queue, frame.wireBytes);
+  return packet;
+}
+
+uint32_t
+PointToPointNetDevice::NextTxQueue (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = m_txQueues.size ();
+  if (m_txScheduler == STRICT_PRIORITY || n == 1)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          if (!m_txQueues[i].queue->IsEmpty ())
+            {
+              return i;
+            }
+        }
+      return n;
+    }
+
+  //
+  // Weighted round robin: the current queue sends until its credit is used
+  // up or it runs dry, then the next non-empty queue gets a fresh credit.
+  // One full turn plus a return to the starting queue visits them all.
+  //
+  for (uint32_t visited = 0; visited <= n; visited++)
+    {
+      TxQueue &current = m_txQueues[m_wrrCurrent];
+      if (m_wrrCredit > 0 && !current.queue->IsEmpty ())
+        {
+          m_wrrCredit--;
+          return m_wrrCurrent;
+        }
+      m_wrrCurrent = (m_wrrCurrent + 1) % n;
+      m_wrrCredit = m_txQueues[m_wrrCurrent].weight;
+    }
+  return n;
+}
+
+bool
+PointToPointNetDevice::TxQueuesEmpty (void) const
+{
+  for (std::vector<TxQueue>::const_iterator i = m_txQueues.begin (); i != m_txQueues.end (); ++i)
+    {
+      if (!i->queue->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+uint32_t
+PointToPointNetDevice::QueueForLevel (uint8_t level) const
+{
+  // Spread the eight levels evenly, most urgent first
+  return (7 - std::min<uint8_t> (level, 7)) * m_txQueues.size () / 8;
+}
+
+uint32_t
+PointToPointNetDevice::ClassifyQueue (Ptr<const Packet> p, uint16_t protocol) const
+{
+  NS_LOG_FUNCTION (this << p << protocol);
+  uint32_t n = m_txQueues.size ();
+  if (n <= 1)
+    {
+      return 0;
+    }
+  if (m_queueClassifier == CLASSIFY_PRIORITY_TAG)
+    {
+      SocketPriorityTag priorityTag;
+      if (p->PeekPacketTag (priorityTag))
+        {
+          return QueueForLevel (priorityTag.GetPriority ());
+        }
+      return n - 1;
+    }
+
+  //
+  // The device cannot use the internet module headers, so read the DSCP
+  // straight from the first two bytes of the IPv4/IPv6 header.  Its three
+  // class selector bits give the level.
+  //
+  uint8_t ip[2];
+  if ((protocol == 0x0800 || protocol == 0x86DD) && p->CopyData (ip, 2) == 2)
+    {
+      uint8_t dscp = protocol == 0x0800
+        ? ip[1] >> 2
+        : (((ip[0] & 0x0f) << 4) | (ip[1] >> 4)) >> 2;
+      return QueueForLevel (dscp >> 3);
+    }
+  return n - 1;
+}
+
+uint8_t
+PointToPointNetDevice::SelectQueue (Ptr<QueueItem> item) const
+{
+  NS_LOG_FUNCTION (this << item);
+  if (m_queueClassifier == CLASSIFY_PRIORITY_TAG)
+    {
+      SocketPriorityTag priorityTag;
+      if (item->GetPacket ()->PeekPacketTag (priorityTag))
+        {
+          return QueueForLevel (priorityTag.GetPriority ());
+        }
+      return m_txQueues.size () - 1;
+    }
+  uint8_t tos;
+  if (item->GetUint8Value (QueueItem::IP_DSFIELD, tos))
+    {
+      return QueueForLevel (tos >> 5);
+    }
+  return m_txQueues.size () - 1;
+}
+
 bool
 PointToPointNetDevice::Attach (Ptr<PointToPointChannel> ch)
 {
@@ -388,7 +918,44 @@ void
 PointToPointNetDevice::SetQueue (Ptr<Queue<Packet> > q)
 {
   NS_LOG_FUNCTION (this << q);
-  m_queue = q;
+  if (m_txQueues.empty ())
+    {
+      AddTxQueue (q);
+      return;
+    }
+  m_txQueues[0].queue = q;
+}
+
+uint32_t
+PointToPointNetDevice::AddTxQueue (Ptr<Queue<Packet> > queue, uint32_t weight, bool compress)
+{
+  NS_LOG_FUNCTION (this << queue << weight << compress);
+  NS_ASSERT_MSG (weight > 0, "A transmit queue needs a weight of at least 1");
+  TxQueue txQueue;
+  txQueue.queue = queue;
+  txQueue.weight = weight;
+  txQueue.compress = compress;
+  m_txQueues.push_back (txQueue);
+  if (m_txQueues.size () == 1)
+    {
+      m_wrrCredit = weight;
+    }
+  // Rebuilt on the next Send, to recheck the compression policy
+  m_txPipeline.clear ();
+  return m_txQueues.size () - 1;
+}
+
+uint32_t
+PointToPointNetDevice::GetNTxQueues (void) const
+{
+  return m_txQueues.size ();
+}
+
+Ptr<Queue<Packet> >
+PointToPointNetDevice::GetTxQueue (uint32_t i) const
+{
+  NS_ASSERT_MSG (i < m_txQueues.size (), "No transmit queue " << i);
+  return m_txQueues[i].queue;
 }
 
 void
@@ -402,9 +969,6 @@ void
 PointToPointNetDevice::Receive (Ptr<Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet);
-  uint16_t protocol = 0;
-  // m_count++;
-  // std::cout << "Receive packet " << m_count << "\n";
   if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) ) 
     {
       // 
@@ -412,106 +976,194 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // corrupted packet, don't forward this packet up, let it go.
       //
       m_phyRxDropTrace (packet);
+      return;
     }
-  else 
+
+  // 
+  // Hit the trace hooks.  All of these hooks are in the same place in this 
+  // device because it is so simple, but this is not usually the case in
+  // more complicated devices.
+  //
+  if (!m_snifferTrace.IsEmpty () || !m_promiscSnifferTrace.IsEmpty ())
     {
-      // 
-      // Hit the trace hooks.  All of these hooks are in the same place in this 
-      // device because it is so simple, but this is not usually the case in
-      // more complicated devices.
-      //
       m_snifferTrace (packet);
       m_promiscSnifferTrace (packet);
-      m_phyRxEndTrace (packet);
+    }
+  m_phyRxEndTrace (packet);
 
-      //
-      // Trace sinks will expect complete packets, not packets without some of the
-      // headers.
-      //
-      Ptr<Packet> originalPacket = packet->Copy ();
+  if (m_rxCoalesceWindow.IsZero ())
+    {
+      ReceiveFrame (packet);
+      return;
+    }
 
-      if (compressionEnabled)
-        {
-          PppHeader header;
-          packet->PeekHeader(header); // Get the header from the packet
-          uint16_t currentProtocol = header.GetProtocol();
-          switch (currentProtocol)
-            {
-              case 0x4021:  // LZS
-                {
+  //
+  // Interrupt moderation: hold the frame until the window opened by the
+  // first frame of the batch closes, or the budget is reached, and then
+  // process the whole batch in one go.
+  //
+  m_rxBacklog.push_back (std::make_pair (packet, Simulator::Now ()));
+  if (m_rxBacklog.size () >= m_rxCoalesceBudget)
+    {
+      m_rxPollEvent.Cancel ();
+      ProcessRxBacklog ();
+    }
+  else if (!m_rxPollEvent.IsRunning ())
+    {
+      m_rxPollEvent = Simulator::Schedule (m_rxCoalesceWindow, &PointToPointNetDevice::ProcessRxBacklog, this);
+    }
+}
 
-                  //std::cout << "recv: Got LZS packet: 0x" << std::hex << currentProtocol << "\n";
-                  /* Decompress the compressed packet */
-                  // Ether to PPP header
-                  /* Remove the header so it's back to what we compressed */
-                  packet -> RemoveHeader(header);
-                  uint32_t packetSize = packet->GetSize();
-                  //std::cout << "Received As String 1: " << packet -> ToString() << "\n";
-                  /* Allocate enough memory to the buffer so we don't get a seg fault */
-                 //  uint32_t adjustedPacketSize = packetSize + 8;
-                  uint8_t* buffer = new uint8_t[packetSize];
-                  uint8_t* newBuffer = new uint8_t[packetSize];
-                  packet -> CopyData(buffer, packetSize);
-                  //printf("Packet Data In Receive: %s\n", buffer);
-                  //printf ("Size of Packet in Decompress: %d  \n", packetSize);
-                  /* If we successfully serialized, do the next thing */
-                  Decompress(buffer, newBuffer, packetSize);
-                  /* Create the new, decompressed packet. Change packet to point to that. */
-                  packet = Create<Packet>(newBuffer, packetSize);
-                  //std::cout << "Adding 0x0021\n";
-                  AddHeader(packet, 0x0021);
-                  //std::cout << "Received As String 2: " << packet -> ToString() << "\n";
-                  break;
-                }
-            }
+void
+PointToPointNetDevice::ProcessRxBacklog (void)
+{
+  NS_LOG_FUNCTION (this << m_rxBacklog.size ());
+  // Frames delivered below may lead to more frames arriving in this same
+  // event (e.g. over a zero delay link), so work on a snapshot
+  if (m_rxBacklog.empty ())
+    {
+      return;
+    }
+  std::vector<std::pair<Ptr<Packet>, Time> > backlog;
+  backlog.swap (m_rxBacklog);
+  Time now = Simulator::Now ();
+  m_rxBatchTrace (backlog.size (), now - backlog.front ().second);
+  for (std::vector<std::pair<Ptr<Packet>, Time> >::const_iterator i = backlog.begin (); i != backlog.end (); ++i)
+    {
+      m_rxCoalesceDelayTrace (i->first, now - i->second);
+      ReceiveFrame (i->first);
+    }
+}
 
-          //
-          // Strip off the point-to-point protocol header and forward this packet
-          // up the protocol stack.  Since this is a simple point-to-point link,
-          // there is no difference in what the promisc callback sees and what the
-          // normal receive callback sees.
-          //
+void
+PointToPointNetDevice::ReceiveFrame (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  uint16_t protocol = 0;
+  uint64_t wireUid = packet->GetUid ();
 
-          ProcessHeader (packet, protocol);
+  //
+  // Trace sinks will expect complete packets, not packets without some of the
+  // headers.  Only pay for the copy when one of them is connected; otherwise
+  // originalPacket is the packet itself and the traces below are no-ops.
+  //
+  bool traced = !m_macRxTrace.IsEmpty () || !m_macPromiscRxTrace.IsEmpty ()
+    || (compressionEnabled && (!m_phyRxDropTrace.IsEmpty ()
+                               || !m_crcDropTrace.IsEmpty ()
+                               || !m_desyncDropTrace.IsEmpty ()));
+  Ptr<Packet> originalPacket = traced ? packet->Copy () : packet;
 
-          if (!m_promiscCallback.IsNull ())
+  if (compressionEnabled)
+    {
+      PppHeader header;
+      packet->PeekHeader(header); // Get the header from the packet
+      uint16_t currentProtocol = header.GetProtocol();
+      switch (currentProtocol)
+        {
+          case 0x4021:  // LZS
             {
-              m_macPromiscRxTrace (originalPacket);
-              m_promiscCallback (this, packet, protocol, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
-            }
 
-          m_macRxTrace (originalPacket);
-          // m_rxCallback (this, pCopy, protocol, GetRemote ());
-          m_rxCallback (this, packet, protocol, GetRemote ());
-        } 
-      else
-        {
-          //
-          // Strip off the point-to-point protocol header and forward this packet
-          // up the protocol stack.  Since this is a simple point-to-point link,
-          // there is no difference in what the promisc callback sees and what the
-          // normal receive callback sees.
-          //
-          ProcessHeader (packet, protocol);
+              /* Remove the headers so it's back to what we compressed */
+              packet->RemoveHeader (header);
+              CompressionHeader compression;
+              packet->RemoveHeader (compression);
 
+              bool stateful = compression.HasSequence ();
+              if (stateful && !CheckSequence (compression, originalPacket))
+                {
+                  return;
+                }
 
-          if (!m_promiscCallback.IsNull ())
+              uint32_t packetSize = packet->GetSize ();
+              if (packetSize == 0)
+                {
+                  // Truncated after the compression header; deflate never
+                  // produces an empty frame
+                  NS_LOG_WARN ("empty compressed payload, dropping packet " << originalPacket->GetUid ());
+                  m_codecErrors++;
+                  m_phyRxDropTrace (originalPacket);
+                  if (stateful)
+                    {
+                      LoseSync ();
+                    }
+                  return;
+                }
+              uint32_t originalSize = compression.GetOriginalSize ();
+              std::vector<uint8_t> buffer (packetSize);
+              std::vector<uint8_t> newBuffer (originalSize + 1);
+              packet->CopyData (&buffer[0], packetSize);
+              std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+              bool inflated = stateful
+                ? DecompressStream (&buffer[0], packetSize, &newBuffer[0], originalSize, compression.IsReset ())
+                : Decompress (&buffer[0], packetSize, &newBuffer[0], originalSize);
+              int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+              m_decompressNanoseconds += elapsed;
+              if (!inflated)
+                {
+                  NS_LOG_WARN ("inflate failed, dropping packet " << originalPacket->GetUid ());
+                  m_codecErrors++;
+                  m_phyRxDropTrace (originalPacket);
+                  if (stateful)
+                    {
+                      LoseSync ();
+                    }
+                  return;
+                }
+              if (compression.HasCrc ()
+                  && CRC32CCalculate (&newBuffer[0], originalSize) != compression.GetCrc ())
+                {
+                  NS_LOG_WARN ("CRC32C mismatch, dropping packet " << originalPacket->GetUid ());
+                  m_crcDropTrace (originalPacket);
+                  if (stateful)
+                    {
+                      // The bad data is now part of the inflate history
+                      LoseSync ();
+                    }
+                  return;
+                }
+              /* Create the new, decompressed packet. Change packet to point to that. */
+              packet = Create<Packet> (&newBuffer[0], originalSize);
+              CopyPacketTags (originalPacket, packet);
+              m_decompressTrace (packet, originalSize, packetSize + compression.GetSerializedSize (), elapsed);
+              AddHeader (packet, PppToEther (compression.GetProtocol ()));
+              break;
+            }
+          case 0x80FD:  // CCP
             {
-              m_macPromiscRxTrace (originalPacket);
-              m_promiscCallback (this, packet, protocol, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
+              packet->RemoveHeader (header);
+              ReceiveControl (packet);
+              return;
             }
-
-          m_macRxTrace (originalPacket);
-          m_rxCallback (this, packet, protocol, GetRemote ());
         }
     }
+
+  //
+  // Strip off the point-to-point protocol header and forward this packet
+  // up the protocol stack.  Since this is a simple point-to-point link,
+  // there is no difference in what the promisc callback sees and what the
+  // normal receive callback sees.
+  //
+  ProcessHeader (packet, protocol);
+  if (compressionEnabled)
+    {
+      m_logicalSnifferTrace (packet, wireUid);
+    }
+
+  if (!m_promiscCallback.IsNull ())
+    {
+      m_macPromiscRxTrace (originalPacket);
+      m_promiscCallback (this, packet, protocol, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
+    }
+
+  m_macRxTrace (originalPacket);
+  m_rxCallback (this, packet, protocol, GetRemote ());
 }
 
 Ptr<Queue<Packet> >
 PointToPointNetDevice::GetQueue (void) const
 { 
   NS_LOG_FUNCTION (this);
-  return m_queue;
+  return m_txQueues.empty () ? 0 : m_txQueues[0].queue;
 }
 
 void
@@ -642,160 +1294,234 @@ PointToPointNetDevice::Send (
   NS_LOG_LOGIC ("p=" << packet << ", dest=" << &dest);
   NS_LOG_LOGIC ("UID is " << packet->GetUid ());
 
-  // std::cout << "protocol: " << protocolNumber << "\n";
-  // std::cout << "Sending packet=" << packet << "to dest=" << &dest << "\n";
-  if (compressionEnabled)
+  if (m_txPipeline.empty ())
     {
+      BuildTxPipeline ();
+    }
 
-      if (protocolNumber == m_protocol)  // IPv4
+  PointToPointTxContext context;
+  context.packet = packet;
+  context.protocol = protocolNumber;
+  context.pppProtocol = 0;
+  context.compress = false;
+  context.queue = 0;
+  for (std::vector<TxStageCallback>::const_iterator stage = m_txPipeline.begin ();
+       stage != m_txPipeline.end (); ++stage)
+    {
+      if (!(*stage) (context))
         {
+          return false;
+        }
+    }
+  return true;
+}
 
-          if (IsLinkUp () == false)
-            {
-              m_macTxDropTrace (packet);
-              return false;
-            }
+void
+PointToPointNetDevice::InsertTxStage (PointToPointTxStage::Position position, Ptr<PointToPointTxStage> stage)
+{
+  NS_LOG_FUNCTION (this << position << stage);
+  NS_ASSERT_MSG (position != PointToPointTxStage::ENQUEUE, "Nothing can run after ENQUEUE");
+  m_txStages.push_back (std::make_pair (position, stage));
+  // Rebuilt on the next Send
+  m_txPipeline.clear ();
+}
+
+void
+PointToPointNetDevice::BuildTxPipeline (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (compressionEnabled && m_config == 0)
+    {
+      m_config = &CompressionConfig::Get ();
+    }
 
+  if (compressionEnabled && m_historyEnabled && !m_compressOnDequeue)
+    {
+      uint32_t compressing = 0;
+      for (std::vector<TxQueue>::const_iterator i = m_txQueues.begin (); i != m_txQueues.end (); ++i)
+        {
+          compressing += i->compress ? 1 : 0;
+        }
+      // The peer inflates in wire order, so frames sharing one history must
+      // not overtake each other in different queues
+      if (compressing > 1)
+        {
+          NS_FATAL_ERROR ("History needs all compressed traffic in one transmit queue, "
+                          << compressing << " queues allow compression");
+        }
+    }
 
-          uint32_t packetSize = packet->GetSize();
-          //printf ("Size of Packet in Compress: %d  \n", packetSize);
-          uint32_t adjustedPacketSize = packetSize + 8;
-          //std::cout << "M_Protocol is: " << m_protocol <<"\n";
-          //std::cout << "Protocol Number is: " << protocolNumber <<"\n";
-          /*Add 8 to house the header code since a header is 8 bytes. */
-          uint8_t* buffer = new uint8_t[adjustedPacketSize];
-          uint8_t* newBuffer = new uint8_t[adjustedPacketSize];
-          packet -> CopyData(buffer, adjustedPacketSize);
-
-          //printf("Packet: %d \n ", packetSize);
-          //std::cout << "Sent As String: " << packet -> ToString() << "\n";
-          /* Get contents of packet */
-          
-          packet -> CopyData(newBuffer, adjustedPacketSize);
-          uint8_t* outputData = new uint8_t[adjustedPacketSize];
-          // uint8_t* thirdBuffer = new uint8_t[adjustedPacketSize];
-          /* Compress the data test. This seems to be working */
-          Compress(newBuffer, outputData, adjustedPacketSize);
-          //Decompress(outputData, thirdBuffer, adjustedPacketSize);
-
-          packet = Create<Packet>(outputData, adjustedPacketSize);
-          /* Add the  correct header before sending it */
-          // Stick a point to point protocol header on the packet in preparation for
-          // shoving it out the door.
-          AddHeader (packet, 0x4021);
-          /* This is 1054 instead of 1062 for some reason */
-          //printf("Exiting Packet Size: %d \n", packet -> GetSize());
-          // newPacket -> CopyData(buffer, adjustedPacketSize);
-          //std::cout << "Sent As String 2: " << packet -> ToString() << "\n";          
-          /* Now send newPacket */
-          m_macTxTrace (packet);
-
-          //
-          // We should enqueue and dequeue the packet to hit the tracing hooks.
-          //
-          if (m_queue->Enqueue (packet))
+  m_txPipeline.clear ();
+  for (int position = PointToPointTxStage::CLASSIFY; position <= PointToPointTxStage::ENQUEUE; ++position)
+    {
+      switch (position)
+        {
+        case PointToPointTxStage::CLASSIFY:
+          m_txPipeline.push_back (MakeCallback (&PointToPointNetDevice::ClassifyStage, this));
+          break;
+        case PointToPointTxStage::PAYLOAD_COMPRESS:
+          if (compressionEnabled && !m_compressOnDequeue)
             {
-              //
-              // If the channel is ready for transition we send the packet right now
-              // 
-              if (m_txMachineState == READY)
-                {
-                  packet = m_queue->Dequeue ();
-                  m_snifferTrace (packet);
-                  m_promiscSnifferTrace (packet);
-                  bool ret = TransmitStart (packet);
-                  return ret;
-                }
-              return true;
+              m_txPipeline.push_back (MakeCallback (&PointToPointNetDevice::PayloadCompressStage, this));
             }
-          // Enqueue may fail (overflow)
-          m_macTxDropTrace (packet);
-          return false;
+          break;
+        case PointToPointTxStage::FRAME:
+          m_txPipeline.push_back (MakeCallback (&PointToPointNetDevice::FrameStage, this));
+          break;
+        case PointToPointTxStage::ENQUEUE:
+          m_txPipeline.push_back (MakeCallback (&PointToPointNetDevice::EnqueueStage, this));
+          break;
+        default:
+          break;
         }
-
-      if (IsLinkUp () == false)
+      for (std::vector<std::pair<PointToPointTxStage::Position, Ptr<PointToPointTxStage> > >::const_iterator i = m_txStages.begin ();
+           i != m_txStages.end (); ++i)
         {
-          m_macTxDropTrace (packet);
-          return false;
+          if (i->first == position)
+            {
+              m_txPipeline.push_back (MakeCallback (&PointToPointTxStage::Process, i->second));
+            }
         }
+    }
+  NS_LOG_LOGIC ("Transmit pipeline has " << m_txPipeline.size () << " stages");
+}
 
-      //
-      // Stick a point to point protocol header on the packet in preparation for
-      // shoving it out the door.
-      //
-      AddHeader (packet, protocolNumber);
-      std::cout << "Adding header again with" << protocolNumber << "\n";
+bool
+PointToPointNetDevice::ClassifyStage (PointToPointTxContext &context)
+{
+  NS_LOG_FUNCTION (this << context.packet);
+  //
+  // If IsLinkUp() is false it means there is no channel to send any packet 
+  // over so we just hit the drop trace on the packet and return an error.
+  //
+  if (IsLinkUp () == false)
+    {
+      m_macTxDropTrace (context.packet);
+      return false;
+    }
+  context.pppProtocol = EtherToPpp (context.protocol);
+  context.queue = ClassifyQueue (context.packet, context.protocol);
+  context.compress = m_config != 0 && m_config->IsCompressed (context.pppProtocol)
+    && m_txQueues[context.queue].compress;
+  return true;
+}
 
-      m_macTxTrace (packet);
+bool
+PointToPointNetDevice::PayloadCompressStage (PointToPointTxContext &context)
+{
+  NS_LOG_FUNCTION (this << context.packet);
+  if (!context.compress)
+    {
+      m_packetsBypassed++;
+      m_logicalSnifferTrace (context.packet, context.packet->GetUid ());
+      return true;
+    }
 
-      //
-      // We should enqueue and dequeue the packet to hit the tracing hooks.
-      //
-      if (m_queue->Enqueue (packet))
+  uint32_t packetSize = context.packet->GetSize ();
+  std::vector<uint8_t> buffer (packetSize);
+  context.packet->CopyData (&buffer[0], packetSize);
+
+  // A sync flush appends an empty stored block to the deflate output
+  std::vector<uint8_t> outputData (compressBound (packetSize) + 16);
+  bool reset = false;
+  if (m_historyEnabled && m_flushInterval > 0 && m_txSinceReset >= m_flushInterval)
+    {
+      m_txResetPending = true;
+    }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  uint32_t compressedSize;
+  if (m_historyEnabled)
+    {
+      reset = m_txResetPending;
+      compressedSize = CompressStream (&buffer[0], packetSize, &outputData[0], outputData.size (), reset);
+    }
+  else
+    {
+      compressedSize = Compress (&buffer[0], packetSize, &outputData[0], outputData.size ());
+    }
+  int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+  m_compressNanoseconds += elapsed;
+
+  if (compressedSize > 0)
+    {
+      CompressionHeader compression;
+      compression.SetProtocol (context.pppProtocol);
+      compression.SetOriginalSize (packetSize);
+      if (m_checksumEnabled)
+        {
+          compression.SetCrc (CRC32CCalculate (&buffer[0], packetSize));
+        }
+      if (m_historyEnabled)
         {
-          //
-          // If the channel is ready for transition we send the packet right now
-          // 
-          if (m_txMachineState == READY)
+          compression.SetSequence (m_txSequence++);
+          if (reset)
             {
-              packet = m_queue->Dequeue ();
-              m_snifferTrace (packet);
-              m_promiscSnifferTrace (packet);
-              bool ret = TransmitStart (packet);
-              return ret;
+              compression.SetReset ();
+              m_txResetPending = false;
+              m_txSinceReset = 0;
             }
-          return true;
+          m_txSinceReset++;
         }
 
-      // Enqueue may fail (overflow)
+      Ptr<Packet> packet = Create<Packet> (&outputData[0], compressedSize);
+      CopyPacketTags (context.packet, packet);
+      packet->AddHeader (compression);
 
-      m_macTxDropTrace (packet);
-      return false;
-    } 
-  else
-    {
-    //
-    // If IsLinkUp() is false it means there is no channel to send any packet 
-    // over so we just hit the drop trace on the packet and return an error.
-    //
-    if (IsLinkUp () == false)
-      {
-        m_macTxDropTrace (packet);
-        return false;
-      }
+      m_bytesBeforeCompression += packetSize;
+      m_bytesAfterCompression += packet->GetSize ();
+      m_compressionRatio = static_cast<double> (m_bytesBeforeCompression) / m_bytesAfterCompression;
+      m_compressTrace (context.packet, packetSize, packet->GetSize (), elapsed);
+      m_logicalSnifferTrace (context.packet, packet->GetUid ());
 
-    //
-    // Stick a point to point protocol header on the packet in preparation for
-    // shoving it out the door.
-    //
-    AddHeader (packet, protocolNumber);
+      context.packet = packet;
+      context.pppProtocol = 0x4021;  // LZS
+      return true;
+    }
 
-    m_macTxTrace (packet);
+  // deflate failed; send the packet as it is
+  NS_LOG_WARN ("deflate failed on a " << packetSize << " byte packet, sending it uncompressed");
+  m_codecErrors++;
+  // CompressStream dropped the history; tell the peer with the next frame
+  m_txResetPending = true;
+  m_packetsBypassed++;
+  m_logicalSnifferTrace (context.packet, context.packet->GetUid ());
+  return true;
+}
 
-    //
-    // We should enqueue and dequeue the packet to hit the tracing hooks.
-    //
-    if (m_queue->Enqueue (packet))
-      {
-        //
-        // If the channel is ready for transition we send the packet right now
-        // 
-        if (m_txMachineState == READY)
-          {
-            packet = m_queue->Dequeue ();
-            m_snifferTrace (packet);
-            m_promiscSnifferTrace (packet);
-            bool ret = TransmitStart (packet);
-            return ret;
-          }
-        return true;
-      }
-
-    // Enqueue may fail (overflow)
-
-    m_macTxDropTrace (packet);
-    return false;
-  }
+bool
+PointToPointNetDevice::FrameStage (PointToPointTxContext &context)
+{
+  NS_LOG_FUNCTION (this << context.packet);
+  //
+  // Stick a point to point protocol header on the packet in preparation for
+  // shoving it out the door.
+  //
+  PppHeader ppp;
+  ppp.SetProtocol (context.pppProtocol);
+  context.packet->AddHeader (ppp);
+  m_macTxTrace (context.packet);
+  return true;
+}
+
+bool
+PointToPointNetDevice::EnqueueStage (PointToPointTxContext &context)
+{
+  NS_LOG_FUNCTION (this << context.packet);
+  //
+  // We should enqueue and dequeue the packet to hit the tracing hooks.
+  //
+  if (compressionEnabled && m_compressOnDequeue && !context.compress)
+    {
+      m_packetsBypassed++;
+      if (!m_logicalSnifferTrace.IsEmpty ())
+        {
+          Ptr<Packet> logical = context.packet->Copy ();
+          PppHeader ppp;
+          logical->RemoveHeader (ppp);
+          m_logicalSnifferTrace (logical, context.packet->GetUid ());
+        }
+    }
+  return EnqueueAndTransmit (context.packet, context.queue, context.compress);
 }
 
 bool
@@ -887,6 +1613,24 @@ PointToPointNetDevice::GetMtu (void) const
   return m_mtu;
 }
 
+void
+PointToPointNetDevice::CopyPacketTags (Ptr<const Packet> from, Ptr<Packet> to)
+{
+  NS_LOG_FUNCTION (from << to);
+  PacketTagIterator i = from->GetPacketTagIterator ();
+  while (i.HasNext ())
+    {
+      PacketTagIterator::Item item = i.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      NS_ASSERT_MSG (!constructor.IsNull (), "tag " << item.GetTypeId ().GetName () << " has no constructor");
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      to->AddPacketTag (*tag);
+      delete tag;
+    }
+}
+
 uint16_t
 PointToPointNetDevice::PppToEther (uint16_t proto)
 {
@@ -915,15 +1659,10 @@ PointToPointNetDevice::EtherToPpp (uint16_t proto)
   return 0;
 }
 
-// might just need to take packet as input and modify it within the function
-/* Will need to store the original data somewhere to confirm data is the same */
-/* Big issues with these. Need to deal with pointers to arrays correctly. */
-uint8_t*
-PointToPointNetDevice::Compress (uint8_t* packetData, uint8_t* outputData, uint32_t size)
+uint32_t
+PointToPointNetDevice::Compress (const uint8_t* packetData, uint32_t size, uint8_t* outputData, uint32_t outputSize)
 {
-  
-  //printf("Packet Data In Compress: %s\n", packetData);
-  //printf("Size in Compress: %d \n", size);
+  NS_LOG_FUNCTION (this << size << outputSize);
 
   // zlib struct
   z_stream defstream;
@@ -931,44 +1670,210 @@ PointToPointNetDevice::Compress (uint8_t* packetData, uint8_t* outputData, uint3
   defstream.zfree = Z_NULL;
   defstream.opaque = Z_NULL;
 
-  defstream.avail_in = (uInt)strlen((char*)packetData)+1; // size of input, string + terminator
+  defstream.avail_in = (uInt)(size); // size of input
   defstream.next_in = (Bytef *)packetData; // input char array
-  defstream.avail_out = (uInt)(size); // size of output
+  defstream.avail_out = (uInt)(outputSize); // size of output
   defstream.next_out = (Bytef *)outputData; // output char array
 
   // compress
-  deflateInit(&defstream, Z_BEST_COMPRESSION);
-  deflate(&defstream, Z_FINISH);
-  deflateEnd(&defstream);
-
-  //printf("Compressed data: %s\n", outputData);
-  return outputData;
-}
-
-//figure out return type
-uint8_t*
-PointToPointNetDevice::Decompress (uint8_t* packetData, uint8_t* outputData, uint32_t size)
-{
-   // printf("Packet Data In Decompress: %s\n", packetData);
-    //printf("Size in Decompress: %d \n", size);
-    z_stream infstream;
-    infstream.zalloc = Z_NULL;
-    infstream.zfree = Z_NULL;
-    infstream.opaque = Z_NULL;
-    
-    infstream.avail_in = (uInt)(size-strlen((char*)packetData)); // size of input
-    infstream.next_in = (Bytef *)packetData; // input char array
-    infstream.avail_out = (uInt)(size); // size of output
-    infstream.next_out = (Bytef *)outputData; // output char array
-     
-    // decompress
-    inflateInit(&infstream);
-    inflate(&infstream, Z_NO_FLUSH);
-    inflateEnd(&infstream);
-
-    // printf("Decompressed data: %s\n", outputData);
-    
-    return outputData;
+  if (deflateInit (&defstream, Z_BEST_COMPRESSION) != Z_OK)
+    {
+      return 0;
+    }
+  int ret = deflate (&defstream, Z_FINISH);
+  deflateEnd (&defstream);
+
+  return ret == Z_STREAM_END ? defstream.total_out : 0;
+}
+
+bool
+PointToPointNetDevice::Decompress (const uint8_t* packetData, uint32_t size, uint8_t* outputData, uint32_t outputSize)
+{
+  NS_LOG_FUNCTION (this << size << outputSize);
+  z_stream infstream;
+  infstream.zalloc = Z_NULL;
+  infstream.zfree = Z_NULL;
+  infstream.opaque = Z_NULL;
+
+  infstream.avail_in = (uInt)(size); // size of input
+  infstream.next_in = (Bytef *)packetData; // input char array
+  infstream.avail_out = (uInt)(outputSize); // size of output
+  infstream.next_out = (Bytef *)outputData; // output char array
+
+  // decompress
+  if (inflateInit (&infstream) != Z_OK)
+    {
+      return false;
+    }
+  int ret = inflate (&infstream, Z_FINISH);
+  inflateEnd (&infstream);
+
+  // A well formed frame inflates to exactly the advertised original size
+  return ret == Z_STREAM_END && infstream.total_out == outputSize;
+}
+
+uint32_t
+PointToPointNetDevice::CompressStream (const uint8_t* input, uint32_t size, uint8_t* output, uint32_t outputSize, bool reset)
+{
+  NS_LOG_FUNCTION (this << size << outputSize << reset);
+  if (m_txStream == 0)
+    {
+      m_txStream = new z_stream ();
+      // Raw deflate: there is no zlib header a late joining peer could miss
+      if (deflateInit2 (m_txStream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+          delete m_txStream;
+          m_txStream = 0;
+          return 0;
+        }
+    }
+  else if (reset)
+    {
+      deflateReset (m_txStream);
+    }
+
+  m_txStream->avail_in = (uInt)(size);
+  m_txStream->next_in = (Bytef *)input;
+  m_txStream->avail_out = (uInt)(outputSize);
+  m_txStream->next_out = (Bytef *)output;
+  int ret = deflate (m_txStream, Z_SYNC_FLUSH);
+
+  // All of the input must be flushed out, with room to spare
+  if (ret != Z_OK || m_txStream->avail_in != 0 || m_txStream->avail_out == 0)
+    {
+      deflateReset (m_txStream);
+      return 0;
+    }
+  return outputSize - m_txStream->avail_out;
+}
+
+bool
+PointToPointNetDevice::DecompressStream (const uint8_t* input, uint32_t size, uint8_t* output, uint32_t outputSize, bool reset)
+{
+  NS_LOG_FUNCTION (this << size << outputSize << reset);
+  if (m_rxStream == 0)
+    {
+      m_rxStream = new z_stream ();
+      if (inflateInit2 (m_rxStream, -MAX_WBITS) != Z_OK)
+        {
+          delete m_rxStream;
+          m_rxStream = 0;
+          return false;
+        }
+    }
+  else if (reset)
+    {
+      inflateReset (m_rxStream);
+    }
+
+  m_rxStream->avail_in = (uInt)(size);
+  m_rxStream->next_in = (Bytef *)input;
+  // One spare byte, so the trailing empty block is consumed even when the
+  // data fills outputSize exactly, and so overlong frames are detected
+  m_rxStream->avail_out = (uInt)(outputSize + 1);
+  m_rxStream->next_out = (Bytef *)output;
+  int ret = inflate (m_rxStream, Z_SYNC_FLUSH);
+
+  return ret == Z_OK && m_rxStream->avail_in == 0 && m_rxStream->avail_out == 1;
+}
+
+bool
+PointToPointNetDevice::CheckSequence (const CompressionHeader &compression, Ptr<const Packet> frame)
+{
+  NS_LOG_FUNCTION (this << frame);
+  uint16_t sequence = compression.GetSequence ();
+  if (m_rxSynced && sequence != m_rxSequence)
+    {
+      uint16_t gap = sequence - m_rxSequence;
+      NS_LOG_INFO ("Expected frame " << m_rxSequence << ", got " << sequence
+                   << ": " << gap << " frame(s) lost, history out of sync");
+      m_framesLost += gap;
+      m_rxSynced = false;
+    }
+  m_rxSequence = sequence + 1;
+
+  if (compression.IsReset ())
+    {
+      // DecompressStream starts a new history with this frame
+      m_rxSynced = true;
+      return true;
+    }
+  if (!m_rxSynced)
+    {
+      NS_LOG_LOGIC ("Dropping frame " << sequence << " while out of sync");
+      m_desyncLosses++;
+      m_desyncDropTrace (frame);
+      SendResetRequest ();
+      return false;
+    }
+  return true;
+}
+
+void
+PointToPointNetDevice::LoseSync (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_rxSynced = false;
+  SendResetRequest ();
+}
+
+void
+PointToPointNetDevice::SendResetRequest (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_resetRequestEnabled || IsLinkUp () == false)
+    {
+      return;
+    }
+  if (m_resetRequestsSent.Get () > 0
+      && Simulator::Now () - m_lastResetRequest < m_resetRequestTimeout)
+    {
+      return;
+    }
+
+  // CCP Reset-Request (RFC 1962): code, identifier, length
+  uint8_t request[4] = { 14, ++m_resetRequestId, 0, 4 };
+  Ptr<Packet> packet = Create<Packet> (request, sizeof (request));
+  PppHeader ppp;
+  ppp.SetProtocol (0x80FD);
+  packet->AddHeader (ppp);
+
+  NS_LOG_INFO ("Sending Reset-Request " << (uint32_t)m_resetRequestId);
+  m_resetRequestsSent++;
+  m_lastResetRequest = Simulator::Now ();
+  EnqueueAndTransmit (packet, 0, false);
+}
+
+void
+PointToPointNetDevice::ReceiveControl (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  uint8_t code = 0;
+  p->CopyData (&code, 1);
+  if (code == 14)
+    {
+      // Reset-Request: the next stateful frame starts a new history, which
+      // doubles as the Reset-Ack
+      NS_LOG_INFO ("Peer asked for a history reset");
+      m_txResetPending = true;
+    }
+}
+
+void
+PointToPointNetDevice::ReleaseStreams (void)
+{
+  if (m_txStream != 0)
+    {
+      deflateEnd (m_txStream);
+      delete m_txStream;
+      m_txStream = 0;
+    }
+  if (m_rxStream != 0)
+    {
+      inflateEnd (m_rxStream);
+      delete m_rxStream;
+      m_rxStream = 0;
+    }
 }
 
 } // namespace ns3
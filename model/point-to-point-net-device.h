@@ -26,17 +26,109 @@
 #include "ns3/callback.h"
 #include "ns3/packet.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/event-id.h"
+#include "point-to-point-tx-stage.h"
+#include <deque>
+#include <utility>
+#include <vector>
+
+struct z_stream_s;
 
 namespace ns3 {
 
+namespace TracedValueCallback {
+
+/**
+ * \ingroup point-to-point
+ * TracedValue callback signature for uint64_t
+ *
+ * \param [in] oldValue original value of the traced variable
+ * \param [in] newValue new value of the traced variable
+ */
+typedef void (* Uint64)(uint64_t oldValue, uint64_t newValue);
+
+} // namespace TracedValueCallback
+
+/**
+ * \ingroup point-to-point
+ * \brief A TracedCallback that knows whether any sink is connected
+ *
+ * The device uses IsEmpty to skip building packets (e.g. copies that keep
+ * the headers) that only trace sinks would see.
+ *
+ * The count only sees connections made through this class, which is what
+ * the trace source accessor does for TraceConnect, Config::Connect and
+ * their variants.  A sink connected through a TracedCallback reference to
+ * the member is not counted, and the device then skips what the sink
+ * would have seen.  Disconnecting a callback that was never connected is
+ * not supported either.
+ */
+template <typename T1, typename T2 = empty>
+class CountedTracedCallback : public TracedCallback<T1, T2>
+{
+public:
+  CountedTracedCallback () : m_sinks (0) {}
+
+  /**
+   * \copydoc TracedCallback::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase & callback)
+  {
+    TracedCallback<T1, T2>::ConnectWithoutContext (callback);
+    m_sinks++;
+  }
+
+  /**
+   * \copydoc TracedCallback::Connect
+   */
+  void Connect (const CallbackBase & callback, std::string path)
+  {
+    TracedCallback<T1, T2>::Connect (callback, path);
+    m_sinks++;
+  }
+
+  /**
+   * \copydoc TracedCallback::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase & callback)
+  {
+    TracedCallback<T1, T2>::DisconnectWithoutContext (callback);
+    m_sinks = m_sinks > 0 ? m_sinks - 1 : 0;
+  }
+
+  /**
+   * \copydoc TracedCallback::Disconnect
+   */
+  void Disconnect (const CallbackBase & callback, std::string path)
+  {
+    TracedCallback<T1, T2>::Disconnect (callback, path);
+    m_sinks = m_sinks > 0 ? m_sinks - 1 : 0;
+  }
+
+  /**
+   * \return true if no sink is connected
+   */
+  bool IsEmpty (void) const
+  {
+    return m_sinks == 0;
+  }
+
+private:
+  uint32_t m_sinks; //!< Number of connected sinks
+};
+
 template <typename Item> class Queue;
+class QueueItem;
 class NetDeviceQueueInterface;
 class PointToPointChannel;
 class ErrorModel;
+class CompressionConfig;
+class CompressionHeader;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -86,6 +178,44 @@ public:
    */
   virtual ~PointToPointNetDevice ();
 
+  /**
+   * TracedCallback signature for packets passing through the codec.
+   *
+   * \param [in] packet the uncompressed packet
+   * \param [in] originalSize the payload size before compression
+   * \param [in] compressedSize the frame size after compression, including
+   *             the compression header but not the PPP header
+   * \param [in] nanoseconds the wall-clock time spent in the codec
+   */
+  typedef void (* CompressionTracedCallback)
+    (Ptr<const Packet> packet, uint32_t originalSize, uint32_t compressedSize, int64_t nanoseconds);
+
+  /**
+   * TracedCallback signature for a batch delivered by receive coalescing.
+   *
+   * \param [in] packets the number of frames in the batch
+   * \param [in] delay how long the oldest frame was held
+   */
+  typedef void (* RxBatchTracedCallback)(uint32_t packets, Time delay);
+
+  /**
+   * TracedCallback signature for a frame delivered by receive coalescing.
+   *
+   * \param [in] packet the frame, as received
+   * \param [in] delay how long the frame was held
+   */
+  typedef void (* RxCoalesceDelayTracedCallback)(Ptr<const Packet> packet, Time delay);
+
+  /**
+   * TracedCallback signature for the logical (uncompressed) view of a packet.
+   *
+   * \param [in] packet the packet as the protocol stack sees it, starting
+   *             with its network header
+   * \param [in] wireUid the uid of the frame that carried it on the wire, as
+   *             seen by the Sniffer trace sources
+   */
+  typedef void (* LogicalSnifferTracedCallback)(Ptr<const Packet> packet, uint64_t wireUid);
+
   /**
    * Set the Data Rate used for transmission of packets.  The data rate is
    * set in the Attach () method from the corresponding field in the channel
@@ -128,6 +258,46 @@ public:
    */
   Ptr<Queue<Packet> > GetQueue (void) const;
 
+  /// How the transmitter picks the next queue to serve
+  enum TxScheduler
+  {
+    STRICT_PRIORITY,     //!< Always serve the lowest-index non-empty queue
+    WEIGHTED_ROUND_ROBIN //!< Serve up to weight packets from each queue in turn
+  };
+
+  /// What decides the transmit queue of a packet
+  enum QueueClassifier
+  {
+    CLASSIFY_DSCP,         //!< The DSCP class selector of the IPv4/IPv6 header
+    CLASSIFY_PRIORITY_TAG  //!< The SocketPriorityTag of the packet
+  };
+
+  /**
+   * Add a transmit queue.
+   *
+   * Queues are listed in decreasing priority: the queue set with SetQueue,
+   * or the first one added, has index 0 and gets the most urgent traffic.
+   * With more than one queue, packets are spread over them by the
+   * QueueClassifier attribute and served according to TxScheduler.
+   *
+   * \param queue the queue
+   * \param weight packets served per round with WEIGHTED_ROUND_ROBIN
+   * \param compress false to never compress packets in this queue
+   * \returns the index of the queue
+   */
+  uint32_t AddTxQueue (Ptr<Queue<Packet> > queue, uint32_t weight = 1, bool compress = true);
+
+  /**
+   * \returns the number of transmit queues
+   */
+  uint32_t GetNTxQueues (void) const;
+
+  /**
+   * \param i the index of a transmit queue
+   * \returns the queue
+   */
+  Ptr<Queue<Packet> > GetTxQueue (uint32_t i) const;
+
   /**
    * Attach a receive ErrorModel to the PointToPointNetDevice.
    *
@@ -138,6 +308,17 @@ public:
    */
   void SetReceiveErrorModel (Ptr<ErrorModel> em);
 
+  /**
+   * \brief Add a stage to the transmit pipeline
+   *
+   * The stage runs after the device's own stage at position, and after the
+   * stages inserted at the same position before it.
+   *
+   * \param position where in the pipeline to run the stage; not ENQUEUE
+   * \param stage the stage
+   */
+  void InsertTxStage (PointToPointTxStage::Position position, Ptr<PointToPointTxStage> stage);
+
   /**
    * Receive a packet from a connected PointToPointChannel.
    *
@@ -176,6 +357,17 @@ public:
   virtual bool IsPointToPoint (void) const;
   virtual bool IsBridge (void) const;
 
+  /**
+   * Run the packet through the transmit pipeline.
+   * \see PointToPointTxStage
+   *
+   * \param packet packet sent from above down to Network Device
+   * \param dest mac address of the destination (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        this packet. Used to call the right L3Protocol when the packet
+   *        is received.
+   * \return whether the Send operation succeeded
+   */
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
 
@@ -230,11 +422,234 @@ private:
 
 private:
   
-  uint16_t m_protocol; //<! protocol to compress
+  const CompressionConfig *m_config; //!< Shared config, set when compression is enabled
   bool compressionEnabled;  //<! If should do compression
+  bool m_checksumEnabled;   //!< If compressed frames carry a CRC32C
+  bool m_historyEnabled;    //!< If frames share one deflate history
+  uint32_t m_flushInterval; //!< Compressed frames between history resets, 0 for never
+  bool m_resetRequestEnabled;  //!< If a desynced decompressor asks for a reset
+  Time m_resetRequestTimeout;  //!< Minimum time between two reset requests
+
+  struct z_stream_s *m_txStream; //!< Deflate state shared by transmitted frames
+  struct z_stream_s *m_rxStream; //!< Inflate state shared by received frames
+  uint16_t m_txSequence;    //!< Sequence number of the next stateful frame sent
+  uint16_t m_rxSequence;    //!< Sequence number expected on the next stateful frame
+  bool m_txResetPending;    //!< Reset the deflate history before the next frame
+  bool m_rxSynced;          //!< The inflate history matches the peer's deflate history
+  uint32_t m_txSinceReset;  //!< Stateful frames sent since the last history reset
+  Time m_lastResetRequest;  //!< When the last reset request was sent
+  uint8_t m_resetRequestId; //!< Identifier of the last reset request
+
+  /**
+   * \brief Deflate a buffer
+   * \param input the data to compress
+   * \param size the number of bytes in input
+   * \param output the buffer receiving the deflate stream
+   * \param outputSize the capacity of output, at least compressBound (size)
+   * \return the number of bytes written to output, 0 on failure
+   */
+  uint32_t Compress (const uint8_t* input, uint32_t size, uint8_t* output, uint32_t outputSize);
+
+  /**
+   * \brief Inflate a buffer
+   * \param input the deflate stream
+   * \param size the number of bytes in input
+   * \param output the buffer receiving the original data
+   * \param outputSize the expected size of the original data
+   * \return true if the stream inflated cleanly to exactly outputSize bytes
+   */
+  bool Decompress (const uint8_t* input, uint32_t size, uint8_t* output, uint32_t outputSize);
+
+  /**
+   * \brief Deflate a buffer into the history shared by all stateful frames
+   *
+   * The block is terminated with a sync flush so the peer can inflate it
+   * as soon as it arrives.  On failure the history is reset.
+   *
+   * \param input the data to compress
+   * \param size the number of bytes in input
+   * \param output the buffer receiving the raw deflate block
+   * \param outputSize the capacity of output
+   * \param reset start a new history before compressing input
+   * \return the number of bytes written to output, 0 on failure
+   */
+  uint32_t CompressStream (const uint8_t* input, uint32_t size, uint8_t* output, uint32_t outputSize, bool reset);
+
+  /**
+   * \brief Inflate a block produced by the peer's CompressStream
+   * \param input the raw deflate block
+   * \param size the number of bytes in input
+   * \param output the buffer receiving the original data, at least
+   *        outputSize + 1 bytes
+   * \param outputSize the expected size of the original data
+   * \param reset start a new history before inflating input
+   * \return true if the block inflated cleanly to exactly outputSize bytes
+   */
+  bool DecompressStream (const uint8_t* input, uint32_t size, uint8_t* output, uint32_t outputSize, bool reset);
+
+  /**
+   * \brief Check the sequence number of a received stateful frame
+   *
+   * Gaps in the sequence mean frames were lost on the link (e.g. by the
+   * receive error model), after which the inflate history no longer matches
+   * the peer's until the next reset frame.
+   *
+   * \param compression the compression header of the frame
+   * \param frame the frame as received, for the drop trace
+   * \return true if the frame can be inflated
+   */
+  bool CheckSequence (const CompressionHeader &compression, Ptr<const Packet> frame);
+
+  /**
+   * \brief Mark the inflate history as unusable and ask the peer for a reset
+   */
+  void LoseSync (void);
+
+  /**
+   * \brief Send a CCP Reset-Request to the peer, unless one was sent less
+   * than ResetRequestTimeout ago or reset requests are disabled
+   */
+  void SendResetRequest (void);
+
+  /**
+   * \brief Handle a CCP (0x80FD) frame from the peer
+   * \param p the frame, without its PPP header
+   */
+  void ReceiveControl (Ptr<Packet> p);
+
+  /**
+   * \brief Decompress a received frame and pass it up the stack
+   * \param packet the frame, including its PPP header
+   */
+  void ReceiveFrame (Ptr<Packet> packet);
+
+  /**
+   * \brief Deliver the frames held by receive coalescing as one batch
+   */
+  void ProcessRxBacklog (void);
+
+  /**
+   * \brief Free the deflate/inflate history
+   */
+  void ReleaseStreams (void);
+
+  /// A stage of the transmit pipeline
+  typedef Callback<bool, PointToPointTxContext &> TxStageCallback;
+
+  /**
+   * \brief Assemble m_txPipeline from the device's stages that are enabled
+   * and the inserted stages
+   */
+  void BuildTxPipeline (void);
+
+  /**
+   * \brief Drop the packet if the link is down, and decide whether to compress it
+   * \param context the packet in flight
+   * \return false if the packet was dropped
+   */
+  bool ClassifyStage (PointToPointTxContext &context);
+
+  /**
+   * \brief Deflate the packet and prepend a CompressionHeader; only in the
+   * pipeline when compression is enabled
+   * \param context the packet in flight
+   * \return true; packets that fail to compress are sent as they are
+   */
+  bool PayloadCompressStage (PointToPointTxContext &context);
+
+  /**
+   * \brief Add the PPP header
+   * \param context the packet in flight
+   * \return true
+   */
+  bool FrameStage (PointToPointTxContext &context);
+
+  /**
+   * \brief Queue the frame and start the transmitter
+   * \param context the packet in flight
+   * \return false if the frame was dropped or could not be transmitted
+   */
+  bool EnqueueStage (PointToPointTxContext &context);
+
+  /// Stages inserted with InsertTxStage, with their position
+  std::vector<std::pair<PointToPointTxStage::Position, Ptr<PointToPointTxStage> > > m_txStages;
+  std::vector<TxStageCallback> m_txPipeline; //!< The stages Send runs, in order
+
+  /**
+   * \brief Enqueue a framed packet and start transmitting it if the
+   * transmitter is idle
+   * \param packet the packet, including its PPP header
+   * \param queue the index of the transmit queue
+   * \param compress with CompressOnDequeue, deflate the packet when it leaves
+   * the queue
+   * \return false if the packet was dropped
+   */
+  bool EnqueueAndTransmit (Ptr<Packet> packet, uint32_t queue, bool compress);
+
+  /**
+   * \brief Deflate a frame leaving the queue, with CompressOnDequeue
+   * \param frame the uncompressed frame, including its PPP header
+   * \return the frame to transmit
+   */
+  Ptr<Packet> CompressFrame (Ptr<Packet> frame);
+
+  /**
+   * \brief Tell byte queue limits about bytes entering a transmit queue
+   * \param queue the index of the transmit queue
+   * \param bytes the bytes the frame will take on the wire
+   */
+  void NotifyTxQueued (uint32_t queue, uint32_t bytes);
+
+  /**
+   * \brief Tell byte queue limits about bytes leaving a transmit queue
+   * \param queue the index of the transmit queue
+   * \param bytes the bytes given to NotifyTxQueued for the frame
+   */
+  void NotifyTxDequeued (uint32_t queue, uint32_t bytes);
+
+  /**
+   * \param queue the index of a transmit queue
+   * \return true if a frame of the size of the MTU fits in the queue
+   */
+  bool FullFrameFits (uint32_t queue) const;
+
+  /**
+   * \param p a packet handed to Send, without PPP header
+   * \param protocol its Ethernet protocol number
+   * \return the index of the transmit queue for p
+   */
+  uint32_t ClassifyQueue (Ptr<const Packet> p, uint16_t protocol) const;
+
+  /**
+   * \brief NetDeviceQueueInterface select queue callback
+   * \param item a packet leaving the traffic control layer
+   * \return the index of the transmit queue the device will put it in
+   */
+  uint8_t SelectQueue (Ptr<QueueItem> item) const;
+
+  /**
+   * \param level an urgency level, 0 (best effort) to 7 (most urgent)
+   * \return the transmit queue for that level
+   */
+  uint32_t QueueForLevel (uint8_t level) const;
+
+  /**
+   * \brief Pick the queue to serve next according to TxScheduler
+   * \return the index of the queue, or GetNTxQueues () if all are empty
+   */
+  uint32_t NextTxQueue (void);
+
+  /**
+   * \brief Dequeue the next packet according to TxScheduler
+   * \return the packet, ready for the wire, or 0 if all queues are empty
+   */
+  Ptr<Packet> DequeueNext (void);
+
+  /**
+   * \return true if all transmit queues are empty
+   */
+  bool TxQueuesEmpty (void) const;
 
-  uint8_t* Compress (uint8_t* input, uint8_t* output, uint32_t size);
-  uint8_t* Decompress (uint8_t* input, uint8_t* output, uint32_t size);
   uint8_t* CompressExample (uint32_t size, uint8_t* a, uint8_t* b);
   uint8_t* DecompressExample (uint32_t size, uint8_t* b, uint8_t* c);
   /**
@@ -286,6 +701,21 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Start Sending Several Packets Back to Back.
+   *
+   * Dequeues up to BurstSize - 1 more packets behind p and hands them all to
+   * the channel at once, with a single TransmitComplete scheduled for the end
+   * of the last one.  Each packet reaches the peer at the same time as with
+   * TransmitStart; PhyTxBegin fires for all of them when the burst starts and
+   * PhyTxEnd when it completes.
+   *
+   * \see PointToPointChannel::TransmitBurst ()
+   * \param p the first packet of the burst, already dequeued
+   * \returns true if success, false on failure
+   */
+  bool TransmitBurst (Ptr<Packet> p);
+
   /**
    * \brief Make the link up and running
    *
@@ -324,13 +754,35 @@ private:
    */
   Ptr<PointToPointChannel> m_channel;
 
+  /// What the device remembers about a queued frame
+  struct PendingFrame
+  {
+    uint32_t wireBytes; //!< Bytes reported to byte queue limits
+    bool compress;      //!< If the frame is deflated when it leaves the queue
+  };
+
+  /// A transmit queue and its policy
+  struct TxQueue
+  {
+    Ptr<Queue<Packet> > queue;         //!< The queue
+    uint32_t weight;                   //!< Packets per round with WEIGHTED_ROUND_ROBIN
+    bool compress;                     //!< If packets in this queue may be compressed
+    std::deque<PendingFrame> pending;  //!< One entry per frame in queue, in order
+  };
+
   /**
-   * The Queue which this PointToPointNetDevice uses as a packet source.
-   * Management of this Queue has been delegated to the PointToPointNetDevice
+   * The Queues which this PointToPointNetDevice uses as a packet source, in
+   * decreasing priority.
+   * Management of these Queues has been delegated to the PointToPointNetDevice
    * and it has the responsibility for deletion.
    * \see class DropTailQueue
    */
-  Ptr<Queue<Packet> > m_queue;
+  std::vector<TxQueue> m_txQueues;
+
+  TxScheduler m_txScheduler;         //!< How the next queue to serve is picked
+  QueueClassifier m_queueClassifier; //!< What picks the queue of a packet
+  uint32_t m_wrrCurrent;             //!< Queue being served by WRR
+  uint32_t m_wrrCredit;              //!< Packets the current WRR queue may still send
 
   /**
    * Error model for receive packet events
@@ -355,7 +807,7 @@ private:
    * transition).  This is a promiscuous trace (which doesn't mean a lot here
    * in the point-to-point device).
    */
-  TracedCallback<Ptr<const Packet> > m_macPromiscRxTrace;
+  CountedTracedCallback<Ptr<const Packet> > m_macPromiscRxTrace;
 
   /**
    * The trace source fired for packets successfully received by the device
@@ -363,7 +815,7 @@ private:
    * transition).  This is a non-promiscuous trace (which doesn't mean a lot 
    * here in the point-to-point device).
    */
-  TracedCallback<Ptr<const Packet> > m_macRxTrace;
+  CountedTracedCallback<Ptr<const Packet> > m_macRxTrace;
 
   /**
    * The trace source fired for packets successfully received by the device
@@ -407,7 +859,55 @@ private:
    * This happens if the receiver is not enabled or the error model is active
    * and indicates that the packet is corrupt.
    */
-  TracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
+  CountedTracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
+
+  /**
+   * The trace source fired when a compressed frame inflates cleanly but its
+   * payload does not match the CRC32C carried in the compression header.
+   */
+  CountedTracedCallback<Ptr<const Packet> > m_crcDropTrace;
+
+  /**
+   * The trace source fired after a packet has been compressed.
+   * \see CompressionTracedCallback
+   */
+  TracedCallback<Ptr<const Packet>, uint32_t, uint32_t, int64_t> m_compressTrace;
+
+  /**
+   * The trace source fired after a compressed frame has been inflated.
+   * \see CompressionTracedCallback
+   */
+  TracedCallback<Ptr<const Packet>, uint32_t, uint32_t, int64_t> m_decompressTrace;
+
+  TracedValue<uint64_t> m_bytesBeforeCompression; //!< Payload bytes fed to deflate
+  TracedValue<uint64_t> m_bytesAfterCompression;  //!< Bytes out of deflate, with compression header
+  TracedValue<double> m_compressionRatio;         //!< Before / after, running
+  TracedValue<uint64_t> m_packetsBypassed;        //!< Sent uncompressed with compression on
+  TracedValue<uint64_t> m_compressNanoseconds;    //!< Wall-clock time in deflate
+  TracedValue<uint64_t> m_decompressNanoseconds;  //!< Wall-clock time in inflate
+  TracedValue<uint64_t> m_codecErrors;            //!< deflate/inflate failures
+
+  /**
+   * The trace source fired when a compressed frame is received intact but
+   * dropped because the inflate history is out of sync with the peer.
+   */
+  CountedTracedCallback<Ptr<const Packet> > m_desyncDropTrace;
+
+  /**
+   * The trace source fired when receive coalescing delivers a batch, with
+   * the number of frames and how long the oldest of them was held.
+   */
+  TracedCallback<uint32_t, Time> m_rxBatchTrace;
+
+  /**
+   * The trace source fired for each frame receive coalescing delivers, with
+   * how long it was held.
+   */
+  TracedCallback<Ptr<const Packet>, Time> m_rxCoalesceDelayTrace;
+
+  TracedValue<uint64_t> m_framesLost;         //!< Stateful frames missing from the sequence
+  TracedValue<uint64_t> m_desyncLosses;       //!< Frames dropped while out of sync
+  TracedValue<uint64_t> m_resetRequestsSent;  //!< CCP Reset-Requests sent to the peer
 
   /**
    * A trace source that emulates a non-promiscuous protocol sniffer connected 
@@ -425,7 +925,7 @@ private:
    * this would correspond to the point at which the packet is dispatched to 
    * packet sniffers in \c netif_receive_skb.
    */
-  TracedCallback<Ptr<const Packet> > m_snifferTrace;
+  CountedTracedCallback<Ptr<const Packet> > m_snifferTrace;
 
   /**
    * A trace source that emulates a promiscuous mode protocol sniffer connected
@@ -443,7 +943,13 @@ private:
    * this would correspond to the point at which the packet is dispatched to 
    * packet sniffers in \c netif_receive_skb.
    */
-  TracedCallback<Ptr<const Packet> > m_promiscSnifferTrace;
+  CountedTracedCallback<Ptr<const Packet> > m_promiscSnifferTrace;
+
+  /**
+   * The trace source fired with the uncompressed packet of each frame sent or
+   * received by a compressing device, and the uid of the wire frame.
+   */
+  CountedTracedCallback<Ptr<const Packet>, uint64_t> m_logicalSnifferTrace;
 
   Ptr<Node> m_node;         //!< Node owning this NetDevice
   Ptr<NetDeviceQueueInterface> m_queueInterface;   //!< NetDevice queue interface
@@ -468,6 +974,15 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  uint32_t m_burstSize;     //!< Maximum packets per burst, 1 disables bursts
+  bool m_compressOnDequeue; //!< Deflate frames as they leave the queue rather than in Send
+
+  Time m_rxCoalesceWindow;     //!< Longest a received frame is held, 0 disables coalescing
+  uint32_t m_rxCoalesceBudget; //!< Frames that end a batch early
+  EventId m_rxPollEvent;       //!< Closes the current coalescing window
+  /// Frames held by receive coalescing, with their arrival time
+  std::vector<std::pair<Ptr<Packet>, Time> > m_rxBacklog;
+  std::vector<Ptr<Packet> > m_burst; //!< Packets of the burst in progress
 
   /**
    * \brief PPP to Ethernet protocol number mapping
@@ -482,6 +997,17 @@ private:
    * \return The corresponding PPP protocol number
    */
   static uint16_t EtherToPpp (uint16_t protocol);
+
+  /**
+   * \brief Give a packet built from the bytes of another its packet tags
+   *
+   * Compression and decompression build new packets, which would otherwise
+   * lose tags such as SendTimeTag on the way.
+   *
+   * \param from the packet to copy the tags of
+   * \param to the packet to add them to
+   */
+  static void CopyPacketTags (Ptr<const Packet> from, Ptr<Packet> to);
 };
 
 } // namespace ns3
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: George Riley <riley@ece.gatech.edu>
+ */
+
+#include "point-to-point-remote-channel.h"
+#include "point-to-point-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/log.h"
+#include "ns3/unused.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointRemoteChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (PointToPointRemoteChannel);
+
+TypeId
+PointToPointRemoteChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PointToPointRemoteChannel")
+    .SetParent<PointToPointChannel> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<PointToPointRemoteChannel> ()
+    .AddTraceSource ("MpiTxPackets",
+                     "Packets sent to the remote rank",
+                     MakeTraceSourceAccessor (&PointToPointRemoteChannel::m_mpiTxPackets),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("MpiTxBytes",
+                     "Bytes sent to the remote rank, including the MPI per-packet header",
+                     MakeTraceSourceAccessor (&PointToPointRemoteChannel::m_mpiTxBytes),
+                     "ns3::TracedValueCallback::Uint64")
+  ;
+  return tid;
+}
+
+PointToPointRemoteChannel::PointToPointRemoteChannel ()
+  : m_mpiTxPackets (0),
+    m_mpiTxBytes (0)
+{
+}
+
+PointToPointRemoteChannel::~PointToPointRemoteChannel ()
+{
+}
+
+bool
+PointToPointRemoteChannel::TransmitStart (
+  Ptr<const Packet> p,
+  Ptr<PointToPointNetDevice> src,
+  Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << src);
+  NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
+
+  IsInitialized ();
+
+#ifdef NS3_MPI
+  uint32_t wire = src == GetSource (0) ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+
+  // Calculate the rxTime (absolute)
+  Time rxTime = Simulator::Now () + txTime + GetDelay ();
+  Ptr<Packet> copy = p->Copy ();
+  // MpiInterface sends the serialized packet after the receive time, node
+  // id and interface index
+  m_mpiTxPackets++;
+  m_mpiTxBytes += copy->GetSerializedSize () + 16;
+  MpiInterface::SendPacket (copy, rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
+#else
+  NS_UNUSED (txTime);
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+  return true;
+}
+
+void
+PointToPointRemoteChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("Inter-rank traffic on channel " << GetId () << ": "
+               << m_mpiTxPackets << " packets, " << m_mpiTxBytes << " bytes");
+  PointToPointChannel::DoDispose ();
+}
+
+} // namespace ns3
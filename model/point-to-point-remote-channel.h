@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: George Riley <riley@ece.gatech.edu>
+ */
+
+// This object connects two point-to-point net devices where at least one
+// is not local to this simulator object.  It simply over-rides the transmit
+// method and uses an MPI Send operation instead.
+
+#ifndef POINT_TO_POINT_REMOTE_CHANNEL_H
+#define POINT_TO_POINT_REMOTE_CHANNEL_H
+
+#include "point-to-point-channel.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ *
+ * \brief A Remote Point-To-Point Channel
+ * 
+ * This object connects two point-to-point net devices where at least one
+ * is not local to this simulator object. It simply override the transmit
+ * method and uses an MPI Send operation instead.
+ *
+ * Frames cross the rank boundary exactly as the sending device put them on
+ * the wire, so compressed frames travel compressed and are only inflated by
+ * the device on the receiving rank.  The MpiTxPackets and MpiTxBytes trace
+ * sources count what this rank sent to the other one.  Their totals are
+ * also logged, at INFO level under the PointToPointRemoteChannel log
+ * component, when the channel is disposed.
+ */
+class PointToPointRemoteChannel : public PointToPointChannel
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  /** 
+   * \brief Constructor
+   */
+  PointToPointRemoteChannel ();
+
+  /** 
+   * \brief Deconstructor
+   */
+  ~PointToPointRemoteChannel ();
+
+  /**
+   * \brief Transmit the packet
+   *
+   * \param p Packet to transmit
+   * \param src Source PointToPointNetDevice
+   * \param txTime Transmit time to apply
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
+                              Time txTime);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  TracedValue<uint64_t> m_mpiTxPackets; //!< Packets sent to the other rank
+  TracedValue<uint64_t> m_mpiTxBytes;   //!< Bytes handed to MPI, including its per-packet header
+};
+
+} // namespace ns3
+
+#endif
+
+
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/trace-source-accessor.h"
+#include "point-to-point-trace-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointTraceWriter");
+
+NS_OBJECT_ENSURE_REGISTERED (PointToPointTraceWriter);
+
+namespace {
+
+/**
+ * \return the writers handed out as ascii streams, which must outlive the
+ * OutputStreamWrappers pointing at them
+ */
+std::vector<Ptr<PointToPointTraceWriter> > &
+StreamWriters (void)
+{
+  static std::vector<Ptr<PointToPointTraceWriter> > writers;
+  return writers;
+}
+
+} // anonymous namespace
+
+TypeId
+PointToPointTraceWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PointToPointTraceWriter")
+    .SetParent<Object> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<PointToPointTraceWriter> ()
+    .AddAttribute ("BlockSize",
+                   "Bytes per buffer block; each block is written with a single write",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&PointToPointTraceWriter::m_blockSize),
+                   MakeUintegerChecker<uint32_t> (4096))
+    .AddAttribute ("Blocks",
+                   "Number of buffer blocks, which bounds the memory used",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&PointToPointTraceWriter::m_blocks),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("DropWhenFull",
+                   "Drop records when all blocks are waiting for the disk, "
+                   "instead of stalling the simulation",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointTraceWriter::m_dropWhenFull),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Drops",
+                     "Records dropped because no buffer block was free",
+                     MakeTraceSourceAccessor (&PointToPointTraceWriter::m_drops),
+                     "ns3::TracedValueCallback::Uint64")
+  ;
+  return tid;
+}
+
+PointToPointTraceWriter::PointToPointTraceWriter ()
+  : m_snapLen (65535),
+    m_drops (0),
+    m_open (false),
+    m_closing (false),
+    m_lineBuffer (this),
+    m_stream (&m_lineBuffer)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PointToPointTraceWriter::~PointToPointTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+PointToPointTraceWriter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+PointToPointTraceWriter::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (m_open, "PointToPointTraceWriter::Open(): already open");
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "PointToPointTraceWriter::Open(): Unable to open " << filename);
+
+  // One block is filled while the others are free or being written
+  m_current.reserve (m_blockSize);
+  for (uint32_t i = 1; i < m_blocks; i++)
+    {
+      m_free.push_back (std::vector<uint8_t> ());
+      m_free.back ().reserve (m_blockSize);
+    }
+  m_open = true;
+  m_closing = false;
+  m_thread = std::thread (&PointToPointTraceWriter::Run, this);
+  Simulator::ScheduleDestroy (&PointToPointTraceWriter::Close, Ptr<PointToPointTraceWriter> (this));
+}
+
+void
+PointToPointTraceWriter::Write (const uint8_t *data, uint32_t size)
+{
+  if (!m_open)
+    {
+      m_drops++;
+      return;
+    }
+  if (m_current.size () + size > m_blockSize && !m_current.empty ())
+    {
+      std::unique_lock<std::mutex> lock (m_mutex);
+      if (m_free.empty ())
+        {
+          if (m_dropWhenFull)
+            {
+              m_drops++;
+              return;
+            }
+          NS_LOG_LOGIC ("All blocks are waiting for the disk");
+          m_freeCondition.wait (lock, [this] { return !m_free.empty (); });
+        }
+      m_full.push_back (std::vector<uint8_t> ());
+      m_full.back ().swap (m_current);
+      m_current.swap (m_free.back ());
+      m_free.pop_back ();
+      m_fullCondition.notify_one ();
+    }
+  // A record larger than a block makes its block grow; it is still written once
+  m_current.insert (m_current.end (), data, data + size);
+}
+
+void
+PointToPointTraceWriter::WritePcapHeader (uint32_t dataLinkType, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen);
+  // Native byte order, as PcapFile writes it; readers tell from the magic
+  uint32_t magic = 0xa1b2c3d4;
+  uint16_t versionMajor = 2;
+  uint16_t versionMinor = 4;
+  int32_t zone = 0;
+  uint32_t sigFigs = 0;
+  uint8_t header[24];
+  std::memcpy (header, &magic, 4);
+  std::memcpy (header + 4, &versionMajor, 2);
+  std::memcpy (header + 6, &versionMinor, 2);
+  std::memcpy (header + 8, &zone, 4);
+  std::memcpy (header + 12, &sigFigs, 4);
+  std::memcpy (header + 16, &snapLen, 4);
+  std::memcpy (header + 20, &dataLinkType, 4);
+  m_snapLen = snapLen;
+  Write (header, sizeof (header));
+}
+
+void
+PointToPointTraceWriter::WritePcapPacket (Ptr<const Packet> p)
+{
+  uint64_t us = Simulator::Now ().GetMicroSeconds ();
+  uint32_t header[4];
+  header[0] = static_cast<uint32_t> (us / 1000000);
+  header[1] = static_cast<uint32_t> (us % 1000000);
+  header[3] = p->GetSize ();
+  header[2] = std::min (header[3], m_snapLen);
+  m_scratch.resize (sizeof (header) + header[2]);
+  std::memcpy (&m_scratch[0], header, sizeof (header));
+  p->CopyData (&m_scratch[sizeof (header)], header[2]);
+  Write (&m_scratch[0], m_scratch.size ());
+}
+
+Ptr<OutputStreamWrapper>
+PointToPointTraceWriter::GetStream (void)
+{
+  NS_LOG_FUNCTION (this);
+  StreamWriters ().push_back (this);
+  return Create<OutputStreamWrapper> (&m_stream);
+}
+
+uint64_t
+PointToPointTraceWriter::GetDrops (void) const
+{
+  return m_drops;
+}
+
+void
+PointToPointTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_open)
+    {
+      return;
+    }
+  m_lineBuffer.sync ();
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    if (!m_current.empty ())
+      {
+        // No free block is needed any more, so nothing is dropped here
+        m_full.push_back (std::vector<uint8_t> ());
+        m_full.back ().swap (m_current);
+      }
+    m_closing = true;
+    m_fullCondition.notify_one ();
+  }
+  m_thread.join ();
+  m_file.close ();
+  m_open = false;
+  m_free.clear ();
+  if (m_drops.Get () > 0)
+    {
+      NS_LOG_WARN (m_drops << " trace records dropped");
+    }
+}
+
+void
+PointToPointTraceWriter::Run (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      m_fullCondition.wait (lock, [this] { return !m_full.empty () || m_closing; });
+      if (m_full.empty ())
+        {
+          break;
+        }
+      std::vector<uint8_t> block;
+      block.swap (m_full.front ());
+      m_full.pop_front ();
+      lock.unlock ();
+      m_file.write (reinterpret_cast<const char *> (block.data ()), block.size ());
+      block.clear ();
+      lock.lock ();
+      m_free.push_back (std::vector<uint8_t> ());
+      m_free.back ().swap (block);
+      m_freeCondition.notify_one ();
+    }
+  m_file.flush ();
+}
+
+PointToPointTraceWriter::LineBuffer::LineBuffer (PointToPointTraceWriter *writer)
+  : m_writer (writer)
+{
+}
+
+PointToPointTraceWriter::LineBuffer::int_type
+PointToPointTraceWriter::LineBuffer::overflow (int_type c)
+{
+  if (traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      return traits_type::not_eof (c);
+    }
+  m_line.push_back (traits_type::to_char_type (c));
+  if (c == '\n')
+    {
+      sync ();
+    }
+  return c;
+}
+
+std::streamsize
+PointToPointTraceWriter::LineBuffer::xsputn (const char *s, std::streamsize n)
+{
+  m_line.append (s, n);
+  if (n > 0 && s[n - 1] == '\n')
+    {
+      sync ();
+    }
+  return n;
+}
+
+int
+PointToPointTraceWriter::LineBuffer::sync (void)
+{
+  if (!m_line.empty ())
+    {
+      m_writer->Write (reinterpret_cast<const uint8_t *> (m_line.data ()), m_line.size ());
+      m_line.clear ();
+    }
+  return 0;
+}
+
+} // namespace ns3
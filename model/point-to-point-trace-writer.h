@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_TRACE_WRITER_H
+#define POINT_TO_POINT_TRACE_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-value.h"
+#include "ns3/output-stream-wrapper.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup point-to-point
+ * \brief Trace file writer that moves file I/O off the simulator thread
+ *
+ * Records are copied into preallocated blocks of BlockSize bytes.  A full
+ * block is handed to a background thread, which writes it to the file in
+ * one sequential write while the simulation goes on with the next block.
+ * At most Blocks blocks exist; when all of them are waiting for the disk,
+ * the simulator thread either waits for one (the default) or, with
+ * DropWhenFull, drops the record and counts it in Drops.  A record is
+ * always written or dropped as a whole, so the file stays well formed.
+ *
+ * The writer serves pcap files through WritePcapHeader and WritePcapPacket,
+ * and ascii traces through GetStream, whose lines are records.  It is closed,
+ * and its last block written, when the simulator is destroyed.
+ *
+ * PointToPointHelper::SetAsyncTraceWriter makes the helper use it for the
+ * files it creates.
+ */
+class PointToPointTraceWriter : public Object
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  PointToPointTraceWriter ();
+  virtual ~PointToPointTraceWriter ();
+
+  /**
+   * \brief Create the file and start the writer thread
+   * \param filename the file to write
+   */
+  void Open (std::string filename);
+
+  /**
+   * \brief Write one record
+   * \param data the record
+   * \param size its size in bytes
+   */
+  void Write (const uint8_t *data, uint32_t size);
+
+  /**
+   * \brief Write a pcap file header, as the first record of the file
+   * \param dataLinkType the data link type, e.g. PcapHelper::DLT_PPP
+   * \param snapLen the largest number of bytes kept of each packet
+   */
+  void WritePcapHeader (uint32_t dataLinkType, uint32_t snapLen = 65535);
+
+  /**
+   * \brief Write a pcap record of a packet, stamped with the current time
+   * \param p the packet
+   */
+  void WritePcapPacket (Ptr<const Packet> p);
+
+  /**
+   * \brief Get an ascii stream writing through this writer
+   *
+   * Each line written to the stream is one record.  The writer stays alive
+   * until the program exits, since OutputStreamWrapper does not own the
+   * stream.
+   *
+   * \return the stream
+   */
+  Ptr<OutputStreamWrapper> GetStream (void);
+
+  /**
+   * \return the number of records dropped because no block was free
+   */
+  uint64_t GetDrops (void) const;
+
+  /**
+   * \brief Write everything buffered and stop the writer thread
+   *
+   * Records written afterwards are dropped.
+   */
+  void Close (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// The stream buffer of GetStream, which writes each line as a record
+  class LineBuffer : public std::streambuf
+  {
+public:
+    /// \param writer the writer receiving the lines
+    LineBuffer (PointToPointTraceWriter *writer);
+    virtual int sync (void);
+
+protected:
+    virtual int_type overflow (int_type c);
+    virtual std::streamsize xsputn (const char *s, std::streamsize n);
+
+private:
+    PointToPointTraceWriter *m_writer; //!< The writer receiving the lines
+    std::string m_line;                //!< The line being built
+  };
+
+  /// Body of the writer thread
+  void Run (void);
+
+  uint32_t m_blockSize;   //!< Bytes per block
+  uint32_t m_blocks;      //!< Blocks allocated
+  bool m_dropWhenFull;    //!< Drop records rather than wait for a free block
+  uint32_t m_snapLen;     //!< Snap length given to WritePcapHeader
+  TracedValue<uint64_t> m_drops; //!< Records dropped
+
+  std::ofstream m_file;                      //!< The file, only used by the writer thread
+  std::vector<uint8_t> m_current;            //!< Block being filled by the simulator thread
+  std::vector<std::vector<uint8_t> > m_free; //!< Empty blocks
+  std::deque<std::vector<uint8_t> > m_full;  //!< Blocks waiting for the disk, in order
+  std::mutex m_mutex;                        //!< Protects m_free, m_full and m_closing
+  std::condition_variable m_fullCondition;   //!< Signals a block in m_full, or closing
+  std::condition_variable m_freeCondition;   //!< Signals a block in m_free
+  std::thread m_thread;                      //!< The writer thread
+  bool m_open;                               //!< Open was called and Close was not
+  bool m_closing;                            //!< The writer thread should exit once m_full is empty
+
+  std::vector<uint8_t> m_scratch; //!< Reused to build a pcap record
+  LineBuffer m_lineBuffer;        //!< Buffer of m_stream
+  std::ostream m_stream;          //!< The stream returned by GetStream
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_TRACE_WRITER_H */
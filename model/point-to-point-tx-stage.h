@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_TX_STAGE_H
+#define POINT_TO_POINT_TX_STAGE_H
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief A packet travelling through the PointToPointNetDevice transmit
+ * pipeline.
+ */
+struct PointToPointTxContext
+{
+  Ptr<Packet> packet;    //!< The packet; replaced by the payload compress stage
+  uint16_t protocol;     //!< Ethernet protocol number passed to Send
+  uint16_t pppProtocol;  //!< PPP protocol the frame stage writes
+  bool compress;         //!< If the payload compress stage should deflate the packet
+  uint32_t queue;        //!< Index of the transmit queue the enqueue stage uses
+};
+
+/**
+ * \ingroup point-to-point
+ * \brief One step of the PointToPointNetDevice transmit pipeline
+ *
+ * PointToPointNetDevice::Send runs every packet through the stages
+ *
+ *   CLASSIFY -> HEADER_COMPRESS -> PAYLOAD_COMPRESS -> FRAME -> ENQUEUE
+ *
+ * The device provides CLASSIFY (link check, transmit queue and compression
+ * decision), PAYLOAD_COMPRESS (only when the Compression attribute is set and
+ * CompressOnDequeue is not), FRAME (PPP header) and ENQUEUE.  Stages inserted at a position run right after the
+ * device's own stage at that position, in insertion order: a stage at
+ * CLASSIFY may override PointToPointTxContext::queue or compress, one at
+ * HEADER_COMPRESS sees the classified packet before deflate, and one at
+ * FRAME sees the complete frame before it is queued.
+ *
+ * The pipeline only holds the stages that are in use, so a disabled stage
+ * costs nothing per packet.
+ */
+class PointToPointTxStage : public Object
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  /// Positions in the transmit pipeline
+  enum Position
+  {
+    CLASSIFY,
+    HEADER_COMPRESS,
+    PAYLOAD_COMPRESS,
+    FRAME,
+    ENQUEUE
+  };
+
+  PointToPointTxStage ();
+  virtual ~PointToPointTxStage ();
+
+  /**
+   * \brief Process a packet
+   * \param context the packet and what the earlier stages decided about it
+   * \return false to stop the pipeline; the stage is then responsible for
+   * having traced the packet as dropped, and Send returns false
+   */
+  virtual bool Process (PointToPointTxContext &context) = 0;
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_TX_STAGE_H */
@@ -0,0 +1,41 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "random-payload.h"
+
+namespace ns3 {
+
+void
+FillRandomPayload (uint8_t *buffer, uint32_t size, uint64_t seed)
+{
+  uint32_t words = size / 8;
+  for (uint32_t i = 0; i < words; i++)
+    {
+      uint64_t z = RandomPayloadWord (seed, i);
+      for (uint32_t b = 0; b < 8; b++)
+        {
+          buffer[8 * i + b] = z >> (8 * b);
+        }
+    }
+  uint64_t z = RandomPayloadWord (seed, words);
+  for (uint32_t i = 8 * words; i < size; i++)
+    {
+      buffer[i] = z;
+      z >>= 8;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "send-time-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (SendTimeTag);
+
+TypeId
+SendTimeTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SendTimeTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<SendTimeTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+SendTimeTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+SendTimeTag::SendTimeTag ()
+{
+}
+
+SendTimeTag::SendTimeTag (Time sendTime)
+  : m_sendTime (sendTime)
+{
+}
+
+void
+SendTimeTag::SetSendTime (Time sendTime)
+{
+  m_sendTime = sendTime;
+}
+
+Time
+SendTimeTag::GetSendTime (void) const
+{
+  return m_sendTime;
+}
+
+uint32_t
+SendTimeTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+SendTimeTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (m_sendTime.GetTimeStep ());
+}
+
+void
+SendTimeTag::Deserialize (TagBuffer i)
+{
+  m_sendTime = TimeStep (i.ReadU64 ());
+}
+
+void
+SendTimeTag::Print (std::ostream &os) const
+{
+  os << "SendTime=" << m_sendTime.GetSeconds ();
+}
+
+} // namespace ns3
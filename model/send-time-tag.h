@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SEND_TIME_TAG_H
+#define SEND_TIME_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup udpapp
+ * \brief Packet tag with the time a packet was meant to be sent
+ *
+ * UdpAppClient hands several packets to its socket in one event when it
+ * paces them, so the time a packet enters the stack can be earlier than
+ * its place in the schedule; this tag carries the latter.  Compressing
+ * point-to-point devices carry it across the link, and UdpAppServer reports
+ * the delay from it through its RxDelay trace.
+ */
+class SendTimeTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  SendTimeTag ();
+
+  /**
+   * \param sendTime the time the packet was meant to be sent
+   */
+  SendTimeTag (Time sendTime);
+
+  /**
+   * \param sendTime the time the packet was meant to be sent
+   */
+  void SetSendTime (Time sendTime);
+
+  /**
+   * \return the time the packet was meant to be sent
+   */
+  Time GetSendTime (void) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  Time m_sendTime; //!< The time the packet was meant to be sent
+};
+
+} // namespace ns3
+
+#endif /* SEND_TIME_TAG_H */
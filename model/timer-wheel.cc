@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "timer-wheel.h"
+
+namespace ns3 {
+
+TimerWheel::TimerWheel ()
+  : m_now (0),
+    m_size (0)
+{
+  std::memset (m_occupied, 0, sizeof (m_occupied));
+}
+
+void
+TimerWheel::Insert (uint32_t id, uint64_t tick)
+{
+  Entry entry = { id, tick };
+  Place (entry);
+  m_size++;
+}
+
+void
+TimerWheel::Place (const Entry &entry)
+{
+  if (entry.tick <= m_now)
+    {
+      m_due.push_back (entry);
+      return;
+    }
+  // The highest digit in which the tick differs from now; the digits above
+  // it are equal, and this one is larger
+  uint32_t level = (63 - __builtin_clzll (entry.tick ^ m_now)) / BITS;
+  if (level >= LEVELS)
+    {
+      m_overflow.push_back (entry);
+      return;
+    }
+  uint32_t slot = (entry.tick >> (level * BITS)) & (SLOTS - 1);
+  m_slots[level][slot].push_back (entry);
+  m_occupied[level][slot / 64] |= uint64_t (1) << (slot % 64);
+}
+
+uint32_t
+TimerWheel::FindSlot (uint32_t level, uint32_t from) const
+{
+  if (from >= SLOTS)
+    {
+      return SLOTS;
+    }
+  uint32_t word = from / 64;
+  uint64_t bits = m_occupied[level][word] & (~uint64_t (0) << (from % 64));
+  while (true)
+    {
+      if (bits)
+        {
+          return word * 64 + __builtin_ctzll (bits);
+        }
+      if (++word == SLOTS / 64)
+        {
+          return SLOTS;
+        }
+      bits = m_occupied[level][word];
+    }
+}
+
+uint64_t
+TimerWheel::FindNext (uint32_t &level, uint32_t &slot) const
+{
+  // A slot of a lower level is always due before any slot of a higher one
+  for (level = 0; level < LEVELS; level++)
+    {
+      uint32_t shift = level * BITS;
+      slot = FindSlot (level, ((m_now >> shift) & (SLOTS - 1)) + 1);
+      if (slot < SLOTS)
+        {
+          uint64_t above = m_now >> (shift + BITS) << (shift + BITS);
+          return above | (uint64_t (slot) << shift);
+        }
+    }
+  slot = 0;
+  if (!m_overflow.empty ())
+    {
+      // The overflow list is sorted out when the top level wraps around
+      return ((m_now >> (LEVELS * BITS)) + 1) << (LEVELS * BITS);
+    }
+  return UINT64_MAX;
+}
+
+void
+TimerWheel::Advance (uint64_t tick, std::vector<uint32_t> &expired)
+{
+  while (true)
+    {
+      for (std::vector<Entry>::const_iterator i = m_due.begin (); i != m_due.end (); ++i)
+        {
+          expired.push_back (i->id);
+        }
+      m_size -= m_due.size ();
+      m_due.clear ();
+
+      uint32_t level;
+      uint32_t slot;
+      uint64_t next = FindNext (level, slot);
+      if (next > tick)
+        {
+          break;
+        }
+      m_now = next;
+      if (level < LEVELS)
+        {
+          m_moving.swap (m_slots[level][slot]);
+          m_occupied[level][slot / 64] &= ~(uint64_t (1) << (slot % 64));
+        }
+      else
+        {
+          m_moving.swap (m_overflow);
+        }
+      // Everything moves to a lower level, or is due now
+      for (std::vector<Entry>::const_iterator i = m_moving.begin (); i != m_moving.end (); ++i)
+        {
+          Place (*i);
+        }
+      m_moving.clear ();
+    }
+  // Nothing is due up to tick, so every entry keeps its place
+  if (tick > m_now)
+    {
+      m_now = tick;
+    }
+}
+
+uint64_t
+TimerWheel::GetNextTick (void) const
+{
+  if (!m_due.empty ())
+    {
+      return m_now;
+    }
+  uint32_t level;
+  uint32_t slot;
+  return FindNext (level, slot);
+}
+
+uint64_t
+TimerWheel::GetCurrentTick (void) const
+{
+  return m_now;
+}
+
+uint32_t
+TimerWheel::GetSize (void) const
+{
+  return m_size;
+}
+
+void
+TimerWheel::Clear (void)
+{
+  for (uint32_t level = 0; level < LEVELS; level++)
+    {
+      for (uint32_t slot = 0; slot < SLOTS; slot++)
+        {
+          m_slots[level][slot].clear ();
+        }
+    }
+  std::memset (m_occupied, 0, sizeof (m_occupied));
+  m_overflow.clear ();
+  m_due.clear ();
+  m_size = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpapp
+ * \brief Hierarchical timer wheel of integer ids
+ *
+ * Each id expires at a tick.  The wheel has four levels of 256 slots; an
+ * id is kept at the level of the highest 8-bit digit in which its tick
+ * differs from the current tick, in the slot of that digit, and moves to a
+ * lower level when the current tick reaches its slot.  Ticks more than
+ * 2^32 ahead wait in an overflow list.  Inserting is constant time, and
+ * finding the next tick with work is a scan of occupancy bitmaps, so the
+ * cost depends on the number of ids, not on the span of time covered.
+ */
+class TimerWheel
+{
+public:
+  TimerWheel ();
+
+  /**
+   * \brief Add an id
+   *
+   * An id whose tick has already come expires at the next Advance.
+   *
+   * \param id the id
+   * \param tick the tick it expires at
+   */
+  void Insert (uint32_t id, uint64_t tick);
+
+  /**
+   * \brief Move the current tick forward, collecting the ids that expire
+   * \param tick the new current tick; earlier ticks are ignored
+   * \param expired where the expired ids are appended, in tick order
+   */
+  void Advance (uint64_t tick, std::vector<uint32_t> &expired);
+
+  /**
+   * \brief Get the next tick at which Advance has work to do
+   *
+   * This is the tick of the earliest id, or earlier when ids have to move
+   * down a level first.
+   *
+   * \return the tick, or UINT64_MAX if the wheel is empty
+   */
+  uint64_t GetNextTick (void) const;
+
+  /**
+   * \return the current tick
+   */
+  uint64_t GetCurrentTick (void) const;
+
+  /**
+   * \return the number of ids in the wheel
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \brief Remove every id, keeping the current tick
+   */
+  void Clear (void);
+
+private:
+  static const uint32_t LEVELS = 4; //!< Number of levels
+  static const uint32_t BITS = 8;   //!< Bits of the tick per level
+  static const uint32_t SLOTS = 1 << BITS; //!< Slots per level
+
+  /// An id and its tick
+  struct Entry
+  {
+    uint32_t id;   //!< The id
+    uint64_t tick; //!< The tick it expires at
+  };
+
+  /**
+   * \brief Put an entry where it belongs relative to the current tick
+   * \param entry the entry
+   */
+  void Place (const Entry &entry);
+
+  /**
+   * \brief Find the first occupied slot of a level from a slot on
+   * \param level the level
+   * \param from the first slot to look at
+   * \return the slot, or SLOTS if there is none
+   */
+  uint32_t FindSlot (uint32_t level, uint32_t from) const;
+
+  /**
+   * \brief Find the next slot to expire or move down
+   * \param [out] level its level, or LEVELS for the overflow list
+   * \param [out] slot its slot
+   * \return the tick at which it is due, or UINT64_MAX if the wheel is empty
+   */
+  uint64_t FindNext (uint32_t &level, uint32_t &slot) const;
+
+  uint64_t m_now;  //!< The current tick
+  uint32_t m_size; //!< Ids in the wheel
+  std::vector<Entry> m_slots[LEVELS][SLOTS]; //!< The entries of each slot
+  uint64_t m_occupied[LEVELS][SLOTS / 64];   //!< Bitmaps of the non-empty slots
+  std::vector<Entry> m_overflow; //!< Entries beyond the last level
+  std::vector<Entry> m_due;      //!< Entries at or before the current tick
+  std::vector<Entry> m_moving;   //!< Reused while a slot moves down
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
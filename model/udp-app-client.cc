@@ -16,6 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/nstime.h"
@@ -26,15 +27,19 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
 #include "udp-app-client.h"
-#include <chrono>
-#include <thread>
+#include "payload-corpus.h"
+#include "payload-generator.h"
+#include "send-time-tag.h"
+#include <algorithm>
+#include <sstream>
+#include <nlohmann/json.hpp>
 #include <iostream>
-#include <unistd.h>
-#include <fcntl.h>
-#include <fstream>
-#include <bitset>
+#include <vector>
 
 namespace ns3 {
 
@@ -42,6 +47,8 @@ NS_LOG_COMPONENT_DEFINE ("UdpAppClientApplication");
 
 NS_OBJECT_ENSURE_REGISTERED (UdpAppClient);
 
+using json = nlohmann::json;
+
 TypeId
 UdpAppClient::GetTypeId (void)
 {
@@ -73,6 +80,54 @@ UdpAppClient::GetTypeId (void)
                     UintegerValue (1100),
                     MakeUintegerAccessor (&UdpAppClient::m_size),
                     MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Schedule",
+                   "Phases to send, e.g. \"low:6001:15ms:1s,high:6000:15ms\" or the same as a "
+                   "JSON array of {type, count, interval, gap}; empty for MaxPackets + 1 low "
+                   "entropy packets, a 1s gap and MaxPackets high entropy ones, every Interval",
+                   StringValue (""),
+                   MakeStringAccessor (&UdpAppClient::m_schedule),
+                   MakeStringChecker ())
+    .AddAttribute ("DataRate",
+                   "Rate to pace packets at, overriding the intervals of the Schedule; "
+                   "0 to use the intervals",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&UdpAppClient::m_rate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("BucketSize",
+                   "Depth in bytes of a token bucket filled at DataRate; packets are "
+                   "then sent as soon as tokens allow, instead of evenly paced. 0 to pace; "
+                   "less than PacketSize counts as PacketSize",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&UdpAppClient::m_bucketSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BurstSize",
+                   "Largest number of packets handed to the socket in one event",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&UdpAppClient::m_burstSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Jitter",
+                   "Seconds added to each paced interval",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"),
+                   MakePointerAccessor (&UdpAppClient::m_jitter),
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("PayloadFile",
+                   "File the high entropy payloads are read from, shared by all clients; "
+                   "if empty, they come from the PayloadGenerator",
+                   StringValue (""),
+                   MakeStringAccessor (&UdpAppClient::m_payloadFile),
+                   MakeStringChecker ())
+    .AddAttribute ("PayloadStride",
+                   "Bytes between the starts of consecutive payloads in PayloadFile; "
+                   "0 means the payload size",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&UdpAppClient::m_payloadStride),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PayloadGenerator",
+                   "Generator of the high entropy payloads, e.g. "
+                   "ns3::EntropyPayloadGenerator[Entropy=4]",
+                   StringValue ("ns3::RandomPayloadGenerator"),
+                   MakePointerAccessor (&UdpAppClient::m_payloadGenerator),
+                   MakePointerChecker<PayloadGenerator> ())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&UdpAppClient::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -95,26 +150,13 @@ UdpAppClient::UdpAppClient ()
   NS_LOG_FUNCTION (this);
   m_sent_l = 0;
   m_sent_h = 0;
+  m_phase = 0;
+  m_phaseSent = 0;
+  m_tokens = 0;
   m_socket = 0;
   m_sendEvent = EventId ();
   m_data = 0;
   m_dataSize = 0;
-  uint8_t packets[6144000] = {};
-  packets[0] = 0;
-  if (packets[0] == 0) {
-
-  }
-  uint8_t lowPackets[1024] = {};
-  for (int i = 0; i < 1024; i++) {
-    lowPackets[i] = 0;
-  }
-  if (lowPackets[0] == 0 ) {
-    std::cout << "in constructor\n";
-  }
-  //uint8_t * packets2;
-
-//  std::cout << "location of packets: " << &packets << "\n";
-    
 }
 
 UdpAppClient::~UdpAppClient()
@@ -128,6 +170,14 @@ UdpAppClient::~UdpAppClient()
   m_dataSize = 0;
 }
 
+int64_t
+UdpAppClient::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_jitter->SetStream (stream);
+  return 1 + m_payloadGenerator->AssignStreams (stream + 1);
+}
+
 void 
 UdpAppClient::SetRemote (Address ip, uint16_t port)
 {
@@ -147,6 +197,9 @@ void
 UdpAppClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_corpus = 0;
+  m_payloadGenerator = 0;
+  m_jitter = 0;
   Application::DoDispose ();
 }
 
@@ -154,10 +207,18 @@ void
 UdpAppClient::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
-  std::thread::id this_id = std::this_thread::get_id();
-  std::cout << "thread ID: " << this_id << "\n";
+  ParseSchedule ();
+  m_phase = 0;
+  m_phaseSent = 0;
+  while (m_phase < m_phases.size () && m_phases[m_phase].count == 0)
+    {
+      m_phase++;
+    }
 
-  FillInPacketArray(packets);
+  if (!m_payloadFile.empty ())
+    {
+      m_corpus = PayloadCorpus::Get (m_payloadFile);
+    }
 
   if (m_socket == 0)
     {
@@ -201,10 +262,23 @@ UdpAppClient::StartApplication (void)
         }
     }
 
+  m_socket->GetSockName (m_localAddress);
+  m_nextSendTime = Simulator::Now ();
+  m_lastRefill = Simulator::Now ();
+  if (m_bucketSize > 0 && m_bucketSize < m_size)
+    {
+      NS_LOG_WARN ("BucketSize " << m_bucketSize << " is below PacketSize " << m_size <<
+                   "; the bucket holds one packet");
+    }
+  m_tokens = std::max (m_bucketSize, m_size);
+
   std::cout << "Start first send.\n";
   m_socket->SetRecvCallback (MakeCallback (&UdpAppClient::HandleRead, this));
   m_socket->SetAllowBroadcast (true);
-  ScheduleTransmit (Seconds (0.));
+  if (m_phase < m_phases.size ())
+    {
+      ScheduleTransmit (Seconds (0.));
+    }
 }
 
 void 
@@ -339,24 +413,93 @@ UdpAppClient::Send (void)
 
   NS_ASSERT (m_sendEvent.IsExpired ());
 
-  Ptr<Packet> p;
-  std::thread::id this_id = std::this_thread::get_id();
-  if (m_dataSize)
+  const Phase &phase = m_phases[m_phase];
+  uint32_t sent = 0;
+  if (m_rate.GetBitRate () > 0 && m_bucketSize > 0)
     {
-      //std::cout << "m_dataSize\n";
-
-      // MEMCPY the correct portion of packets to mdata
-    	delete [] m_data;
-      	m_data = new uint8_t [m_dataSize];
-      	m_dataSize = m_dataSize;
-
-      	int i = m_sent_l - 6000;
-      	i = 1024 * i;
-
-      	std::copy(packets + i, packets + i + 1024, m_data);
+      // Token bucket: send what the tokens allow, all at once.  The bucket
+      // holds at least one packet, or none could ever be sent
+      double depth = std::max (m_bucketSize, m_size);
+      m_tokens = std::min<double> (m_tokens + (Simulator::Now () - m_lastRefill).GetSeconds ()
+                                   * m_rate.GetBitRate () / 8, depth);
+      m_lastRefill = Simulator::Now ();
+      while (sent < m_burstSize && m_phaseSent < phase.count && m_tokens >= m_size)
+        {
+          m_tokens -= SendPacket (phase, Simulator::Now ());
+          sent++;
+        }
+      if (m_phaseSent < phase.count)
+        {
+          // Wait until the next packet can go, at least a time step if
+          // tokens are missing, lest rounding keeps the refill at zero
+          Time wait = Seconds (0);
+          if (m_tokens < m_size)
+            {
+              wait = Max (Seconds ((m_size - m_tokens) * 8 / m_rate.GetBitRate ()), TimeStep (1));
+            }
+          ScheduleTransmit (wait);
+          return;
+        }
+    }
+  else
+    {
+      // Paced: every packet has its own send time; those of a burst are
+      // handed to the socket together, at the send time of the first
+      while (sent < m_burstSize && m_phaseSent < phase.count)
+        {
+          uint32_t size = SendPacket (phase, m_nextSendTime);
+          Time interval = m_rate.GetBitRate () > 0 ? m_rate.CalculateBytesTxTime (size) : phase.interval;
+          interval += Seconds (m_jitter->GetValue ());
+          m_nextSendTime += Max (interval, Seconds (0));
+          sent++;
+        }
+      if (m_phaseSent < phase.count)
+        {
+          ScheduleTransmit (Max (m_nextSendTime - Simulator::Now (), Seconds (0)));
+          return;
+        }
+    }
 
-      	//std::cout << m_data << "\n";
+  // The phase is over; the next one starts after its gap, in simulated time
+  NS_LOG_INFO ("Client sent " << m_phaseSent << (phase.high ? " high" : " low") << " entropy packets");
+  Time gap = phase.gap;
+  m_phaseSent = 0;
+  m_phase++;
+  while (m_phase < m_phases.size () && m_phases[m_phase].count == 0)
+    {
+      gap += m_phases[m_phase].gap;
+      m_phase++;
+    }
+  if (m_phase < m_phases.size ())
+    {
+      NS_LOG_INFO ("Phase " << m_phase << " starts in " << gap.GetSeconds () << "s");
+      m_nextSendTime = Simulator::Now () + gap;
+      ScheduleTransmit (gap);
+    }
+}
 
+uint32_t
+UdpAppClient::SendPacket (const Phase &phase, Time sendTime)
+{
+  NS_LOG_FUNCTION (this << phase.high << sendTime);
+  Ptr<Packet> p;
+  if (phase.high)
+    {
+      if (m_corpus)
+        {
+          // The n-th high entropy packet starts n strides into the corpus
+          uint32_t stride = m_payloadStride ? m_payloadStride : m_size;
+          uint64_t offset = uint64_t (m_sent_h) * stride;
+          p = Create<Packet> (m_corpus->GetPayload (offset, m_size), m_size);
+        }
+      else
+        {
+          p = m_payloadGenerator->CreatePacket (m_size);
+        }
+    }
+  else if (m_dataSize)
+    {
+      //
       // If m_dataSize is non-zero, we have a data buffer of the same size that we
       // are expected to copy and send.  This state of affairs is created if one of
       // the Fill functions is called.  In this case, m_size must have been set
@@ -364,18 +507,10 @@ UdpAppClient::Send (void)
       //
       NS_ASSERT_MSG (m_dataSize == m_size, "UdpAppClient::Send(): m_size and m_dataSize inconsistent");
       NS_ASSERT_MSG (m_data, "UdpAppClient::Send(): m_dataSize but no m_data");
-      // std::cout << "Reached max packets: " << (m_sent_l == m_count) << "\n";
       p = Create<Packet> (m_data, m_dataSize);
-      //p = Create<Packet> (m_size);
     }
   else
     {
-    	// so the high entropy packets aren't longer b/c of additional copying
-    	delete [] m_data;
-      	m_data = new uint8_t [1024];
-      	int i = m_sent_l * 1024;     	
-      	std::copy(packets + i, packets + i + 1024, m_data);
-
       //
       // If m_dataSize is zero, the client has indicated that it doesn't care
       // about the data itself either by specifying the data size by setting
@@ -383,80 +518,126 @@ UdpAppClient::Send (void)
       // this case, we don't worry about it either.  But we do allow m_size
       // to have a value different from the (zero) m_dataSize.
       //
-      
-      //std::copy(lowPackets + 0, lowPackets + 1024, m_data);
-      p = Create<Packet> (lowPackets, 1024);
-
-
-      //p = Create<Packet> (m_size);
+      p = Create<Packet> (m_size);
     }
-  Address localAddress;
-  m_socket->GetSockName (localAddress);
+  p->AddPacketTag (SendTimeTag (sendTime));
+  uint32_t size = p->GetSize ();
   // call to the trace sinks before the packet is actually sent,
   // so that tags added to the packet can be sent as well
   m_txTrace (p);
   if (Ipv4Address::IsMatchingType (m_peerAddress))
     {
-      m_txTraceWithAddresses (p, localAddress, InetSocketAddress (Ipv4Address::ConvertFrom (m_peerAddress), m_peerPort));
+      m_txTraceWithAddresses (p, m_localAddress, InetSocketAddress (Ipv4Address::ConvertFrom (m_peerAddress), m_peerPort));
     }
   else if (Ipv6Address::IsMatchingType (m_peerAddress))
     {
-      m_txTraceWithAddresses (p, localAddress, Inet6SocketAddress (Ipv6Address::ConvertFrom (m_peerAddress), m_peerPort));
+      m_txTraceWithAddresses (p, m_localAddress, Inet6SocketAddress (Ipv6Address::ConvertFrom (m_peerAddress), m_peerPort));
     }
   m_socket->Send (p);
   ++m_sent_l;
-  // std::cout << "Sent packet " << m_sent_l << "\n"; // Print to check # of packets sent
-  // if (m_sent_l < m_count)
-  //   {
-  //     ++m_sent_l;
-  //   }
-  // else
-  //   {
-  //     ++m_sent_h;
-  //     // std::cout << "Sent high entropy packet " << m_sent_h << "\n"; // Print to check # of packets sent
-  //   }
+  ++m_phaseSent;
+  if (phase.high)
+    {
+      ++m_sent_h;
+    }
   if (Ipv4Address::IsMatchingType (m_peerAddress))
     {
-      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << m_size << " bytes to " <<
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << size << " bytes to " <<
                    Ipv4Address::ConvertFrom (m_peerAddress) << " port " << m_peerPort);
     }
   else if (Ipv6Address::IsMatchingType (m_peerAddress))
     {
-      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << m_size << " bytes to " <<
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << size << " bytes to " <<
                    Ipv6Address::ConvertFrom (m_peerAddress) << " port " << m_peerPort);
     }
   else if (InetSocketAddress::IsMatchingType (m_peerAddress))
     {
-      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << m_size << " bytes to " <<
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << size << " bytes to " <<
                    InetSocketAddress::ConvertFrom (m_peerAddress).GetIpv4 () << " port " << InetSocketAddress::ConvertFrom (m_peerAddress).GetPort ());
     }
   else if (Inet6SocketAddress::IsMatchingType (m_peerAddress))
     {
-      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << m_size << " bytes to " <<
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << size << " bytes to " <<
                    Inet6SocketAddress::ConvertFrom (m_peerAddress).GetIpv6 () << " port " << Inet6SocketAddress::ConvertFrom (m_peerAddress).GetPort ());
     }
 
-  if (m_sent_l <= m_count ) // from 1 to 
+  return size;
+}
+
+void
+UdpAppClient::ParseSchedule (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_phases.clear ();
+  if (m_schedule.empty ())
+    {
+      Phase low = { false, m_count + 1, m_interval, Seconds (1.0) };
+      Phase high = { true, m_count, m_interval, Seconds (0.0) };
+      m_phases.push_back (low);
+      m_phases.push_back (high);
+      return;
+    }
+
+  if (m_schedule[0] == '[')
+    {
+      json j;
+      try
+        {
+          j = json::parse (m_schedule);
+          for (json::const_iterator it = j.begin (); it != j.end (); ++it)
+            {
+              Phase phase;
+              phase.high = ParsePhaseType (it->at ("type").get<std::string> ());
+              phase.count = it->at ("count").get<uint32_t> ();
+              phase.interval = it->count ("interval") ? Time (it->at ("interval").get<std::string> ()) : m_interval;
+              phase.gap = it->count ("gap") ? Time (it->at ("gap").get<std::string> ()) : Seconds (0.0);
+              m_phases.push_back (phase);
+            }
+        }
+      catch (json::exception &e)
+        {
+          NS_FATAL_ERROR ("Malformed UdpAppClient schedule " << m_schedule << ": " << e.what ());
+        }
+      return;
+    }
+
+  // type:count[:interval[:gap]], separated by commas
+  std::istringstream phases (m_schedule);
+  std::string item;
+  while (std::getline (phases, item, ','))
     {
-      ScheduleTransmit (m_interval);
+      std::istringstream fields (item);
+      std::string type, count, interval, gap;
+      std::getline (fields, type, ':');
+      std::getline (fields, count, ':');
+      std::getline (fields, interval, ':');
+      std::getline (fields, gap, ':');
+      Phase phase;
+      phase.high = ParsePhaseType (type);
+      std::istringstream countStream (count);
+      countStream >> phase.count;
+      if (count.empty () || countStream.fail ())
+        {
+          NS_FATAL_ERROR ("UdpAppClient schedule phase \"" << item << "\" has no packet count");
+        }
+      phase.interval = interval.empty () ? m_interval : Time (interval);
+      phase.gap = gap.empty () ? Seconds (0.0) : Time (gap);
+      m_phases.push_back (phase);
     }
-  else if (m_sent_l == m_count + 1) // THE FIRST HIGH ENTROPY PACKET
+}
+
+bool
+UdpAppClient::ParsePhaseType (std::string type)
+{
+  if (type == "high")
     {
-      std::cout << this_id << " sent " << m_sent_l << " low entropy packets. Send the next high entropy packets.\n";
-      std::cout << m_count << " m_count\n";
-      std::cout << "CLIENT starting wait\n";
-      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-      std::cout << "CLIENT done waiting, sending 1st high entropy\n";
-      //TODO critical point
-      m_dataSize = 1024;
-      ScheduleTransmit (m_interval);  
-      // ScheduleTransmit (Seconds (20.0));
+      return true;
     }
-  else if (m_sent_l <= m_count*2) 
+  if (type != "low")
     {
-      // std::cout << "Sending dummy message " << m_sent_h << "\n";
-      ScheduleTransmit (m_interval);
+      NS_FATAL_ERROR ("UdpAppClient schedule phase type must be low or high, not \"" << type << "\"");
     }
+  return false;
 }
 
 void
@@ -486,59 +667,4 @@ UdpAppClient::HandleRead (Ptr<Socket> socket)
     }
 }
 
-void
-UdpAppClient::FillInPacketArray(uint8_t packets[6144000])
-{ 
-  std::cout << "Random fill running";
-
-    int i = 0;
-//    int j;
-    std::ifstream randomfile("randomfile");
-    if (!randomfile.good()) { // if file does not already exist
-        std::ofstream randomoutfile("randomfile"); // makes file and fills it in
-        uint8_t buffer[768000]; // 128*6000 random 8-bit #s
-        int fd = open("/dev/random", O_RDONLY);
-        int size = read(fd, buffer, 768000); // put it in buffer
-        size ++;
-        //buffer now contains the random data
-        close(fd);
-        for (i = 0; i < 6000; ++i) { // 6000 packets: 1 line per
-            for (int j = 0; j < 128; j++) { // 128 numbers * 8 bits = 1024
-                randomoutfile << std::bitset<8>(buffer[(128 * i) + j]);
-            }
-            randomoutfile << "\n";
-        }
-        randomoutfile.close();
-    }
-    std::string line;
-    i = 0;
-    // reads file in a line at a time as a string
-    // converts string to uint8_t* and puts in packets array
-    while (std::getline(randomfile, line))
-    {
-        //std::istringstream iss(line);
-        //cout << line;
-        //cout << "\n";
-        //cout << sizeof(line);
-        const uint8_t* p = reinterpret_cast<const uint8_t*>(line.c_str());
-        for (int x = 0; x < 1024; x++) {
-            packets[(i*1024) + x] = p[x];
-        }
-
-
-       //std::cout << sizeof(line) << "\n";
-        //if (i > 2) {
-        //    int x = i - 1;
-        //    std::cout << i << " " << sizeof(&packets[i]) <<" " << packets[i] << "\n";
-        //    std::cout << x << " " << sizeof(&packets[i-1]) <<" " << packets[i-1] << "\n";
-        //    std::cout << i-2 << " " << packets[i-2] << "\n\n";
-        //}
-        i++;
-    }
-        
-
-    //std::randomfile.close();
-    //TODO ??
-
-}
 } // Namespace ns3
@@ -24,17 +24,45 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/random-variable-stream.h"
+#include <string>
+#include <vector>
 
 namespace ns3 {
 
 class Socket;
 class Packet;
+class PayloadCorpus;
+class PayloadGenerator;
 
 /**
  * \ingroup udpapp
  * \brief A Udp App client
  *
  * Every packet sent should be returned by the server and received here.
+ *
+ * The client sends the phases of its Schedule one after the other, each
+ * being a number of low or high entropy packets at a fixed interval, and
+ * a gap before the next phase.  Everything happens in simulated time.  By
+ * default, it sends MaxPackets + 1 packets of zeros, waits one second and
+ * sends MaxPackets high entropy packets.
+ *
+ * DataRate, when set, paces every phase at that rate instead of its
+ * interval, with Jitter added to each interval.  Up to BurstSize packets
+ * whose send times have come are handed to the socket in one event, so a
+ * train at line rate costs one event per burst; each packet carries its
+ * own send time in a SendTimeTag.  With BucketSize, packets go as soon as
+ * a token bucket of that depth filled at DataRate allows.
+ *
+ * Low entropy payloads are zeros,
+ * or the data of SetFill.  High entropy payloads come from PayloadGenerator, which
+ * by default writes random bytes and can instead aim at an entropy, repeat
+ * a pattern, write Markov text or mix sizes.  Runs are reproducible from
+ * RngRun and AssignStreams.  Alternatively they come from PayloadFile,
+ * which is mapped once and shared by every client of the process; a client
+ * only keeps its position in it.
  */
 class UdpAppClient : public Application 
 {
@@ -61,6 +89,16 @@ public:
    */
   void SetRemote (Address addr);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
   /**
    * Set the data size of the packet (the number of bytes that are sent as data
    * to the server).  The contents of the data are set to unspecified (don't
@@ -157,7 +195,33 @@ private:
    */
   void HandleRead (Ptr<Socket> socket);
 
-  void FillInPacketArray(uint8_t packets[6144000]);
+  /**
+   * \brief Build m_phases from the Schedule attribute
+   */
+  void ParseSchedule (void);
+
+  /**
+   * \param type a phase type of the Schedule attribute
+   * \return true for high entropy, false for low entropy
+   */
+  static bool ParsePhaseType (std::string type);
+
+  /// A phase of the schedule
+  struct Phase
+  {
+    bool high;      //!< High entropy payloads, otherwise low entropy
+    uint32_t count; //!< Packets to send
+    Time interval;  //!< Time between the packets
+    Time gap;       //!< Time from the last packet to the next phase
+  };
+
+  /**
+   * \brief Build and send one packet of a phase
+   * \param phase the current phase
+   * \param sendTime the send time to tag the packet with
+   * \return the size of the packet
+   */
+  uint32_t SendPacket (const Phase &phase, Time sendTime);
 
   uint32_t m_count; //!< Maximum number of packets the application will send
   Time m_interval; //!< Packet inter-send time
@@ -167,14 +231,27 @@ private:
   uint8_t *m_data; //!< packet payload data
 
   uint32_t m_sent_l; //!< Counter for sent packets
-  uint32_t m_sent_h; //!< Counter for sent packets
+  uint32_t m_sent_h; //!< Counter for sent high entropy packets
+  std::string m_schedule; //!< The Schedule attribute
+  std::vector<Phase> m_phases; //!< Phases to send
+  uint32_t m_phase; //!< Index of the current phase
+  uint32_t m_phaseSent; //!< Packets sent in the current phase
+  DataRate m_rate; //!< Pacing rate, or 0 for the phase intervals
+  uint32_t m_bucketSize; //!< Token bucket depth in bytes, or 0 to pace
+  uint32_t m_burstSize; //!< Most packets sent per event
+  Ptr<RandomVariableStream> m_jitter; //!< Seconds added to each interval
+  Time m_nextSendTime; //!< Send time of the next paced packet
+  double m_tokens; //!< Bytes the token bucket allows
+  Time m_lastRefill; //!< Last time tokens were added
+  Address m_localAddress; //!< Address of m_socket, for the traces
   Ptr<Socket> m_socket; //!< Socket
   Address m_peerAddress; //!< Remote peer address
   uint16_t m_peerPort; //!< Remote peer port
   EventId m_sendEvent; //!< Event to send the next packet
-  uint8_t packets[6144000]; // !< Data structure for storing random data
-  uint8_t lowPackets[1024];
-  //uint8_t * packets2;
+  std::string m_payloadFile; //!< File the high entropy payloads come from
+  uint32_t m_payloadStride; //!< Bytes between the starts of consecutive payloads
+  Ptr<const PayloadCorpus> m_corpus; //!< The mapped PayloadFile
+  Ptr<PayloadGenerator> m_payloadGenerator; //!< Writes the high entropy payloads
   /// Callbacks for tracing the packet Tx events
   TracedCallback<Ptr<const Packet> > m_txTrace;
 
@@ -30,6 +30,7 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/ppp-header.h"
+#include "send-time-tag.h"
 #include <chrono>
 
 #include "udp-app-server.h"
@@ -65,6 +66,11 @@ UdpAppServer::GetTypeId (void)
     .AddTraceSource ("RxWithAddresses", "A packet has been received",
                      MakeTraceSourceAccessor (&UdpAppServer::m_rxTraceWithAddresses),
                      "ns3::Packet::TwoAddressTracedCallback")
+    .AddTraceSource ("RxDelay",
+                     "A packet carrying a SendTimeTag has been received, with the time "
+                     "since it was meant to be sent",
+                     MakeTraceSourceAccessor (&UdpAppServer::m_rxDelayTrace),
+                     "ns3::UdpAppServer::DelayTracedCallback")
     .AddAttribute ("PacketSize", "Size of packets generated",
                       UintegerValue (100),
                       MakeUintegerAccessor (&UdpAppServer::m_size),
@@ -254,6 +260,11 @@ UdpAppServer::HandleRead (Ptr<Socket> socket)
       socket->GetSockName (localAddress);
       m_rxTrace (packet);
       m_rxTraceWithAddresses (packet, from, localAddress);
+      SendTimeTag sendTime;
+      if (packet->PeekPacketTag (sendTime))
+        {
+          m_rxDelayTrace (packet, Simulator::Now () - sendTime.GetSendTime ());
+        }
       if (InetSocketAddress::IsMatchingType (from))
         {
           NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s server received " << packet->GetSize () << " bytes from " <<
@@ -23,6 +23,7 @@
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/address.h"
+#include "ns3/nstime.h"
 #include "ns3/traced-callback.h"
 #include <chrono>
 
@@ -53,6 +54,14 @@ public:
   UdpAppServer ();
   virtual ~UdpAppServer ();
 
+  /**
+   * TracedCallback signature for the delay of received packets.
+   *
+   * \param [in] packet The packet.
+   * \param [in] delay The time since the packet was meant to be sent.
+   */
+  typedef void (* DelayTracedCallback)(Ptr<const Packet> packet, Time delay);
+
 protected:
   virtual void DoDispose (void);
 
@@ -89,6 +98,9 @@ private:
 
   /// Callbacks for tracing the packet Rx events, includes source and destination addresses
   TracedCallback<Ptr<const Packet>, const Address &, const Address &> m_rxTraceWithAddresses;
+
+  /// Callbacks for tracing the delay of received packets carrying a SendTimeTag
+  TracedCallback<Ptr<const Packet>, Time> m_rxDelayTrace;
 };
 
 } // namespace ns3
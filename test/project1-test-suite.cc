@@ -5,11 +5,80 @@
 
 // An essential include is test.h
 #include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/crc32c.h"
+#include "ns3/point-to-point-compression-header.h"
+#include "ns3/ppp-header.h"
+#include "ns3/payload-generator.h"
+#include "ns3/timer-wheel.h"
+#include "ns3/pcap-replay-client.h"
+#include "ns3/udp-app-client.h"
+#include "ns3/multi-flow-client.h"
+#include "ns3/send-time-tag.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-app-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-trace-writer.h"
+#include "ns3/queue.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/compression-flow-monitor-helper.h"
+#include "ns3/compression-flow-probe.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/error-model.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/data-rate.h"
+#include "ns3/trace-helper.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
+/**
+ * \brief Connect two nodes with a point-to-point link numbered 10.1.1.0/24
+ *
+ * Compressing devices compress IPv4, whatever config.json the tests run
+ * next to.
+ *
+ * \param p2p the helper to build the link with
+ * \param nodes the two nodes, which get an internet stack
+ * \return the devices of the link
+ */
+static NetDeviceContainer
+InstallLink (PointToPointHelper &p2p, NodeContainer &nodes)
+{
+  Config::SetGlobal ("CompressionConfigJson", StringValue ("{\"protocolsToCompress\": \"0x0021\"}"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (devices);
+  return devices;
+}
+
 // This is an example TestCase.
 class Project1TestCase1 : public TestCase
 {
@@ -46,6 +115,1609 @@ Project1TestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * Check CRC32C against the RFC 3720 test vectors and that the compression
+ * header survives a trip through a packet with and without a CRC and a
+ * sequence number.
+ */
+class CompressionIntegrityTestCase : public TestCase
+{
+public:
+  CompressionIntegrityTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CompressionIntegrityTestCase::CompressionIntegrityTestCase ()
+  : TestCase ("CRC32C and compression header serialization")
+{
+}
+
+void
+CompressionIntegrityTestCase::DoRun (void)
+{
+  const uint8_t digits[] = "123456789";
+  NS_TEST_ASSERT_MSG_EQ (CRC32CCalculate (digits, 9), 0xe3069283, "CRC32C check value");
+
+  uint8_t zeros[32] = {};
+  NS_TEST_ASSERT_MSG_EQ (CRC32CCalculate (zeros, 32), 0x8a9136aa, "CRC32C of 32 zero bytes");
+
+  Ptr<Packet> p = Create<Packet> (100);
+  CompressionHeader plain;
+  plain.SetProtocol (0x0021);
+  plain.SetOriginalSize (1024);
+  p->AddHeader (plain);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 105, "header without CRC is 5 bytes");
+  CompressionHeader h;
+  p->RemoveHeader (h);
+  NS_TEST_ASSERT_MSG_EQ (h.HasCrc (), false, "no CRC expected");
+  NS_TEST_ASSERT_MSG_EQ (h.GetProtocol (), 0x0021, "protocol round trip");
+  NS_TEST_ASSERT_MSG_EQ (h.GetOriginalSize (), 1024, "size round trip");
+
+  CompressionHeader withCrc;
+  withCrc.SetOriginalSize (1024);
+  withCrc.SetCrc (0xe3069283);
+  p->AddHeader (withCrc);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 109, "header with CRC is 9 bytes");
+  p->RemoveHeader (h);
+  NS_TEST_ASSERT_MSG_EQ (h.HasCrc (), true, "CRC expected");
+  NS_TEST_ASSERT_MSG_EQ (h.GetCrc (), 0xe3069283, "CRC round trip");
+
+  CompressionHeader stateful;
+  stateful.SetOriginalSize (1024);
+  stateful.SetSequence (65535);
+  stateful.SetReset ();
+  stateful.SetCrc (0xe3069283);
+  p->AddHeader (stateful);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 111, "header with sequence and CRC is 11 bytes");
+  p->RemoveHeader (h);
+  NS_TEST_ASSERT_MSG_EQ (h.HasSequence (), true, "sequence expected");
+  NS_TEST_ASSERT_MSG_EQ (h.GetSequence (), 65535, "sequence round trip");
+  NS_TEST_ASSERT_MSG_EQ (h.IsReset (), true, "reset flag round trip");
+  NS_TEST_ASSERT_MSG_EQ (h.GetCrc (), 0xe3069283, "CRC after sequence round trip");
+}
+
+/**
+ * Check that payload generators are reproducible from their seed and
+ * produce what they are configured for.
+ */
+class PayloadGeneratorTestCase : public TestCase
+{
+public:
+  PayloadGeneratorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PayloadGeneratorTestCase::PayloadGeneratorTestCase ()
+  : TestCase ("Payload generators")
+{
+}
+
+void
+PayloadGeneratorTestCase::DoRun (void)
+{
+  std::vector<uint8_t> a (65536);
+  std::vector<uint8_t> b (65536);
+
+  Ptr<RandomPayloadGenerator> random = CreateObject<RandomPayloadGenerator> ();
+  random->Generate (&a[0], 1000, 42);
+  random->Generate (&b[0], 1000, 42);
+  NS_TEST_ASSERT_MSG_EQ (std::equal (a.begin (), a.begin () + 1000, b.begin ()), true, "same seed, same payload");
+  random->Generate (&b[0], 1000, 43);
+  NS_TEST_ASSERT_MSG_EQ (std::equal (a.begin (), a.begin () + 1000, b.begin ()), false, "other seed, other payload");
+
+  double targets[] = { 0.0, 2.0, 5.5, 8.0 };
+  for (uint32_t t = 0; t < 4; t++)
+    {
+      Ptr<EntropyPayloadGenerator> entropy = CreateObject<EntropyPayloadGenerator> ();
+      entropy->SetAttribute ("Entropy", DoubleValue (targets[t]));
+      entropy->Generate (&a[0], a.size (), 7);
+      std::vector<uint32_t> counts (256, 0);
+      for (uint32_t i = 0; i < a.size (); i++)
+        {
+          counts[a[i]]++;
+        }
+      double h = 0;
+      for (uint32_t v = 0; v < 256; v++)
+        {
+          if (counts[v])
+            {
+              double p = double (counts[v]) / a.size ();
+              h -= p * std::log2 (p);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ_TOL (h, targets[t], 0.05, "empirical entropy of 64 KiB");
+    }
+
+  Ptr<PatternPayloadGenerator> pattern = CreateObject<PatternPayloadGenerator> ();
+  pattern->SetAttribute ("Period", UintegerValue (10));
+  pattern->Generate (&a[0], 1000, 1);
+  NS_TEST_ASSERT_MSG_EQ (std::equal (a.begin (), a.begin () + 990, a.begin () + 10), true, "period of 10 bytes");
+
+  Ptr<ImixPayloadGenerator> imix = CreateObject<ImixPayloadGenerator> ();
+  imix->SetAttribute ("Sizes", StringValue ("40:1,1500:1"));
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      uint32_t size = imix->GetPayloadSize (1024);
+      NS_TEST_ASSERT_MSG_EQ ((size == 40 || size == 1500), true, "size from the mix");
+    }
+
+  // A pool of 3 hands out its payloads in turn, in new packets
+  Ptr<RandomPayloadGenerator> pooled = CreateObject<RandomPayloadGenerator> ();
+  pooled->SetAttribute ("PoolSize", UintegerValue (3));
+  std::vector<Ptr<Packet> > packets;
+  std::vector<std::vector<uint8_t> > payloads (7, std::vector<uint8_t> (100));
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      packets.push_back (pooled->CreatePacket (100));
+      NS_TEST_ASSERT_MSG_EQ (packets[i]->GetSize (), 100, "size of pooled payload " << i);
+      packets[i]->CopyData (&payloads[i][0], 100);
+    }
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      for (uint32_t j = i + 1; j < 7; j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((payloads[i] == payloads[j]), ((j - i) % 3 == 0),
+                                 "payloads " << i << " and " << j << " of a pool of 3");
+          NS_TEST_ASSERT_MSG_NE (packets[i]->GetUid (), packets[j]->GetUid (), "uids of " << i << " and " << j);
+        }
+    }
+  // Another size rebuilds the pool
+  std::vector<uint8_t> resized (50);
+  pooled->CreatePacket (50)->CopyData (&resized[0], 50);
+  NS_TEST_ASSERT_MSG_EQ (std::equal (resized.begin (), resized.end (), payloads[1].begin ()), false,
+                         "new payloads for a new size");
+}
+
+/**
+ * Check that the timer wheel expires ids at their tick, in order, across
+ * its levels and its overflow list.
+ */
+class TimerWheelTestCase : public TestCase
+{
+public:
+  TimerWheelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TimerWheelTestCase::TimerWheelTestCase ()
+  : TestCase ("Timer wheel")
+{
+}
+
+void
+TimerWheelTestCase::DoRun (void)
+{
+  TimerWheel wheel;
+  uint64_t ticks[] = { 5, 255, 256, 300, 70000, 1ULL << 33, 3 };
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      wheel.Insert (i, ticks[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetSize (), 7, "all ids in the wheel");
+
+  std::vector<uint32_t> expired;
+  wheel.Advance (4, expired);
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 1, "only the id of tick 3");
+  NS_TEST_ASSERT_MSG_EQ (expired[0], 6, "the id of tick 3");
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetNextTick (), 5, "next tick with work");
+
+  // Follow the wheel tick by tick with work, as MultiFlowClient does
+  std::vector<uint64_t> at;
+  expired.clear ();
+  while (wheel.GetNextTick () != UINT64_MAX)
+    {
+      uint32_t before = expired.size ();
+      wheel.Advance (wheel.GetNextTick (), expired);
+      for (uint32_t i = before; i < expired.size (); i++)
+        {
+          at.push_back (wheel.GetCurrentTick ());
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 6, "every other id expired");
+  for (uint32_t i = 0; i < expired.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (expired[i], i, "ids in tick order");
+      NS_TEST_ASSERT_MSG_EQ (at[i], ticks[i], "id expired at its tick");
+    }
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetSize (), 0, "empty wheel");
+
+  // An id whose tick has passed expires at the next advance
+  wheel.Insert (9, 10);
+  expired.clear ();
+  wheel.Advance (wheel.GetCurrentTick (), expired);
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 1, "late id expired at once");
+}
+
+/**
+ * Check that the pcap replay client finds the UDP payload of captured
+ * frames of several link types, and skips what is not a UDP datagram.
+ */
+class PcapReplayTestCase : public TestCase
+{
+public:
+  PcapReplayTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapReplayTestCase::PcapReplayTestCase ()
+  : TestCase ("Pcap replay payload parsing")
+{
+}
+
+void
+PcapReplayTestCase::DoRun (void)
+{
+  uint32_t offset = 0;
+  uint32_t length = 0;
+
+  // Ethernet, one VLAN tag, IPv4 with options, UDP with 100 bytes of payload
+  std::vector<uint8_t> frame (18 + 24 + 8 + 100, 0);
+  frame[12] = 0x81;
+  frame[13] = 0x00;
+  frame[16] = 0x08;
+  frame[17] = 0x00;
+  frame[18] = 0x46;
+  frame[18 + 9] = 17;
+  frame[42 + 5] = 108;
+  NS_TEST_ASSERT_MSG_EQ (PcapReplayClient::FindUdpPayload (PcapHelper::DLT_EN10MB, &frame[0], frame.size (), offset, length),
+                         true, "UDP over tagged Ethernet");
+  NS_TEST_ASSERT_MSG_EQ (offset, 50, "payload after the UDP header");
+  NS_TEST_ASSERT_MSG_EQ (length, 100, "payload size from the UDP header");
+
+  // The size comes from the UDP header even when the capture is cut short
+  NS_TEST_ASSERT_MSG_EQ (PcapReplayClient::FindUdpPayload (PcapHelper::DLT_EN10MB, &frame[0], 60, offset, length),
+                         true, "truncated capture");
+  NS_TEST_ASSERT_MSG_EQ (length, 100, "size of the whole payload");
+
+  frame[18 + 7] = 1;
+  NS_TEST_ASSERT_MSG_EQ (PcapReplayClient::FindUdpPayload (PcapHelper::DLT_EN10MB, &frame[0], frame.size (), offset, length),
+                         false, "fragment after the first");
+  frame[18 + 7] = 0;
+  frame[18 + 9] = 6;
+  NS_TEST_ASSERT_MSG_EQ (PcapReplayClient::FindUdpPayload (PcapHelper::DLT_EN10MB, &frame[0], frame.size (), offset, length),
+                         false, "TCP");
+
+  // PPP, IPv6 with a destination options header, UDP with 10 bytes of payload
+  std::vector<uint8_t> ppp (2 + 40 + 8 + 8 + 10, 0);
+  ppp[1] = 0x57;
+  ppp[2] = 0x60;
+  ppp[2 + 6] = 60;
+  ppp[42] = 17;
+  ppp[50 + 5] = 18;
+  NS_TEST_ASSERT_MSG_EQ (PcapReplayClient::FindUdpPayload (PcapHelper::DLT_PPP, &ppp[0], ppp.size (), offset, length),
+                         true, "UDP over IPv6 over PPP");
+  NS_TEST_ASSERT_MSG_EQ (offset, 58, "payload after the extension header");
+  NS_TEST_ASSERT_MSG_EQ (length, 10, "payload size from the UDP header");
+
+  NS_TEST_ASSERT_MSG_EQ (PcapReplayClient::FindUdpPayload (PcapHelper::DLT_IEEE802_11, &ppp[0], ppp.size (), offset, length),
+                         false, "unknown link type");
+}
+
+/**
+ * Check that a token bucket shallower than a packet still sends, at the
+ * rate it is filled at, one packet at a time.
+ */
+class TokenBucketTestCase : public TestCase
+{
+public:
+  TokenBucketTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the time of a sent packet
+   * \param packet the packet
+   */
+  void Tx (Ptr<const Packet> packet);
+
+  std::vector<Time> m_sendTimes; //!< Times the packets were sent
+};
+
+TokenBucketTestCase::TokenBucketTestCase ()
+  : TestCase ("Token bucket smaller than a packet")
+{
+}
+
+void
+TokenBucketTestCase::Tx (Ptr<const Packet> packet)
+{
+  m_sendTimes.push_back (Simulator::Now ());
+}
+
+void
+TokenBucketTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper stack;
+  stack.Install (node);
+
+  // 10000 bytes per second through a 500 byte bucket: a 1000 byte packet
+  // every 100ms
+  Ptr<UdpAppClient> client = CreateObject<UdpAppClient> ();
+  client->SetRemote (Ipv4Address::GetLoopback (), 9);
+  client->SetAttribute ("PacketSize", UintegerValue (1000));
+  client->SetAttribute ("Schedule", StringValue ("low:20:1ms"));
+  client->SetAttribute ("DataRate", DataRateValue (DataRate ("80kbps")));
+  client->SetAttribute ("BucketSize", UintegerValue (500));
+  client->SetAttribute ("BurstSize", UintegerValue (4));
+  client->TraceConnectWithoutContext ("Tx", MakeCallback (&TokenBucketTestCase::Tx, this));
+  node->AddApplication (client);
+  client->SetStartTime (Seconds (0));
+  client->SetStopTime (Seconds (10));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sendTimes.size (), 20, "every packet is sent");
+  NS_TEST_ASSERT_MSG_EQ (m_sendTimes[0], Seconds (0), "the bucket starts with one packet");
+  for (uint32_t i = 1; i < m_sendTimes.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL ((m_sendTimes[i] - m_sendTimes[i - 1]).GetSeconds (), 0.1, 1e-6,
+                                 "one packet per 100ms, packet " << i);
+    }
+}
+
+/**
+ * Check that the send time of a packet survives compression and
+ * decompression on the link and is reported by the server.
+ */
+class SendTimeTagTestCase : public TestCase
+{
+public:
+  SendTimeTagTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the delay of a received packet
+   * \param packet the packet
+   * \param delay its delay
+   */
+  void RxDelay (Ptr<const Packet> packet, Time delay);
+
+  std::vector<Time> m_delays; //!< Delays of the received packets
+};
+
+SendTimeTagTestCase::SendTimeTagTestCase ()
+  : TestCase ("Send time tag across a compressing link")
+{
+}
+
+void
+SendTimeTagTestCase::RxDelay (Ptr<const Packet> packet, Time delay)
+{
+  m_delays.push_back (delay);
+}
+
+void
+SendTimeTagTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetDeviceAttribute ("Compression", BooleanValue (true));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  InstallLink (p2p, nodes);
+
+  UdpAppServerHelper server (9);
+  ApplicationContainer serverApps = server.Install (nodes.Get (1));
+  serverApps.Get (0)->TraceConnectWithoutContext ("RxDelay", MakeCallback (&SendTimeTagTestCase::RxDelay, this));
+  serverApps.Stop (Seconds (5));
+
+  UdpAppClientHelper client (Ipv4Address ("10.1.1.2"), 9);
+  client.SetAttribute ("PacketSize", UintegerValue (1000));
+  client.SetAttribute ("Schedule", StringValue ("high:10:10ms"));
+  ApplicationContainer clientApps = client.Install (nodes.Get (0));
+  clientApps.Start (Seconds (1));
+  clientApps.Stop (Seconds (5));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_delays.size (), 10, "every packet arrives with its send time");
+  for (uint32_t i = 0; i < m_delays.size (); i++)
+    {
+      // 2ms of propagation, and less than 1ms to transmit
+      NS_TEST_ASSERT_MSG_GT (m_delays[i], MilliSeconds (2), "delay of packet " << i);
+      NS_TEST_ASSERT_MSG_LT (m_delays[i], MilliSeconds (3), "delay of packet " << i);
+    }
+}
+
+/**
+ * Check that transmit bursts deliver every packet when one at a time
+ * transmission would, while taking the packets out of the queue early.
+ */
+class TxBurstTestCase : public TestCase
+{
+public:
+  TxBurstTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send packets back to back over a link
+   * \param burstSize the BurstSize of the devices
+   */
+  void Run (uint32_t burstSize);
+  /**
+   * Hand packets to a device
+   * \param device the device
+   * \param dest the address of its peer
+   * \param n the number of packets
+   */
+  void Send (Ptr<PointToPointNetDevice> device, Address dest, uint32_t n);
+  /**
+   * Record the time a packet arrived
+   * \param packet the packet
+   */
+  void Rx (Ptr<const Packet> packet);
+  /**
+   * Record the number of packets in a queue
+   * \param queue the queue
+   */
+  void Sample (Ptr<Queue<Packet> > queue);
+
+  std::vector<Time> m_arrivals; //!< Arrival times of the packets
+  uint32_t m_queued;            //!< Packets in the queue when sampled
+};
+
+TxBurstTestCase::TxBurstTestCase ()
+  : TestCase ("Transmit bursts keep delivery times")
+{
+}
+
+void
+TxBurstTestCase::Send (Ptr<PointToPointNetDevice> device, Address dest, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (1000), dest, 0x0800);
+    }
+}
+
+void
+TxBurstTestCase::Rx (Ptr<const Packet> packet)
+{
+  m_arrivals.push_back (Simulator::Now ());
+}
+
+void
+TxBurstTestCase::Sample (Ptr<Queue<Packet> > queue)
+{
+  m_queued = queue->GetNPackets ();
+}
+
+void
+TxBurstTestCase::Run (uint32_t burstSize)
+{
+  m_arrivals.clear ();
+  m_queued = 0;
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  // A 1002 byte frame takes 1.002ms
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  p2p.SetDeviceAttribute ("BurstSize", UintegerValue (burstSize));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  Ptr<PointToPointNetDevice> tx = devices.Get (0)->GetObject<PointToPointNetDevice> ();
+  devices.Get (1)->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&TxBurstTestCase::Rx, this));
+
+  Simulator::Schedule (Seconds (0), &TxBurstTestCase::Send, this, tx, devices.Get (1)->GetAddress (), 10);
+  // After the first frame, in the middle of the second
+  Simulator::Schedule (MicroSeconds (1500), &TxBurstTestCase::Sample, this, tx->GetQueue ());
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+TxBurstTestCase::DoRun (void)
+{
+  Run (1);
+  std::vector<Time> single = m_arrivals;
+  uint32_t singleQueued = m_queued;
+  Run (4);
+
+  NS_TEST_ASSERT_MSG_EQ (single.size (), 10, "every packet arrives one at a time");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 10, "every packet arrives in bursts");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (single[i], MicroSeconds (1002 * (i + 1) + 1000), "arrival of packet " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_arrivals[i], single[i], "same arrival in a burst, packet " << i);
+    }
+  // One packet on the wire and 9 queued; the second leaves the queue alone,
+  // or with the 3 after it
+  NS_TEST_ASSERT_MSG_EQ (singleQueued, 8, "queue one at a time");
+  NS_TEST_ASSERT_MSG_EQ (m_queued, 5, "queue in bursts of 4");
+}
+
+/**
+ * Check the per-flow accounting of the compression flow probe, and that it
+ * leaves the FlowMonitor statistics alone.
+ */
+class CompressionFlowProbeTestCase : public TestCase
+{
+public:
+  CompressionFlowProbeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send packets over a compressing link with a flow monitor
+   * \param monitorSender whether the sending node is monitored
+   */
+  void Run (bool monitorSender);
+
+  CompressionFlowProbe::CompressionStatsContainer m_compression; //!< Stats of the probe
+  uint32_t m_probeFlows;      //!< Flows in the FlowProbe stats of the probe
+  uint32_t m_monitoredFlows;  //!< Flows the monitor knows
+  Time m_meanDelay;           //!< Mean delay of the first flow
+};
+
+CompressionFlowProbeTestCase::CompressionFlowProbeTestCase ()
+  : TestCase ("Compression flow probe")
+{
+}
+
+void
+CompressionFlowProbeTestCase::Run (bool monitorSender)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetDeviceAttribute ("Compression", BooleanValue (true));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices = InstallLink (p2p, nodes);
+
+  FlowMonitorHelper flowmon;
+  if (monitorSender)
+    {
+      flowmon.InstallAll ();
+    }
+  else
+    {
+      flowmon.Install (nodes.Get (1));
+    }
+  CompressionFlowMonitorHelper compressionFlowmon;
+  compressionFlowmon.Install (flowmon, NetDeviceContainer (devices.Get (0)));
+
+  UdpAppServerHelper server (9);
+  ApplicationContainer serverApps = server.Install (nodes.Get (1));
+  serverApps.Stop (Seconds (5));
+  UdpAppClientHelper client (Ipv4Address ("10.1.1.2"), 9);
+  client.SetAttribute ("PacketSize", UintegerValue (1000));
+  client.SetAttribute ("Schedule", StringValue ("low:10:10ms"));
+  ApplicationContainer clientApps = client.Install (nodes.Get (0));
+  clientApps.Start (Seconds (1));
+  clientApps.Stop (Seconds (5));
+
+  Simulator::Stop (Seconds (6));
+  Simulator::Run ();
+
+  Ptr<FlowMonitor> monitor = flowmon.GetMonitor ();
+  m_probeFlows = 0;
+  m_compression.clear ();
+  const FlowMonitor::FlowProbeContainer &probes = monitor->GetAllProbes ();
+  for (uint32_t i = 0; i < probes.size (); ++i)
+    {
+      Ptr<CompressionFlowProbe> probe = DynamicCast<CompressionFlowProbe> (probes[i]);
+      if (probe)
+        {
+          m_compression = probe->GetCompressionStats ();
+          m_probeFlows = probe->GetStats ().size ();
+        }
+    }
+  const FlowMonitor::FlowStatsContainer &flows = monitor->GetFlowStats ();
+  m_monitoredFlows = flows.size ();
+  m_meanDelay = Seconds (0);
+  if (!flows.empty () && flows.begin ()->second.rxPackets > 0)
+    {
+      m_meanDelay = flows.begin ()->second.delaySum / flows.begin ()->second.rxPackets;
+    }
+  Simulator::Destroy ();
+}
+
+void
+CompressionFlowProbeTestCase::DoRun (void)
+{
+  Run (true);
+  NS_TEST_ASSERT_MSG_EQ (m_compression.size (), 1, "the client's flow is accounted");
+  const CompressionFlowProbe::CompressionStats &stats = m_compression.begin ()->second;
+  NS_TEST_ASSERT_MSG_EQ (stats.packets, 10, "every packet of the flow");
+  // 1000 bytes of payload, 8 of UDP and 20 of IPv4 header
+  NS_TEST_ASSERT_MSG_EQ (stats.originalBytes, 10 * 1028, "bytes handed to the compressor");
+  NS_TEST_ASSERT_MSG_GT (stats.GetRatio (), 1.5, "zeros compress");
+  NS_TEST_ASSERT_MSG_EQ (m_probeFlows, 0, "no FlowProbe stats without send times");
+  NS_TEST_ASSERT_MSG_GT (m_meanDelay, MilliSeconds (2), "flow delay includes the propagation delay");
+
+  // The monitor never classifies the flow, so every packet misses the cache
+  Run (false);
+  NS_TEST_ASSERT_MSG_EQ (m_monitoredFlows, 0, "nothing classified");
+  NS_TEST_ASSERT_MSG_EQ (m_compression.size (), 0, "unmonitored flows are ignored");
+}
+
+/**
+ * Check that flow control never leaves a transmit queue stopped with
+ * nothing in it to wake it.
+ */
+class TxFlowControlTestCase : public TestCase
+{
+public:
+  TxFlowControlTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Build a link whose first device has flow control
+   * \param maxSize the size of its transmit queue
+   * \return the first device
+   */
+  Ptr<PointToPointNetDevice> Build (std::string maxSize);
+};
+
+TxFlowControlTestCase::TxFlowControlTestCase ()
+  : TestCase ("Transmit flow control")
+{
+}
+
+Ptr<PointToPointNetDevice>
+TxFlowControlTestCase::Build (std::string maxSize)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue (maxSize));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  Ptr<PointToPointNetDevice> device = devices.Get (0)->GetObject<PointToPointNetDevice> ();
+  // What the traffic control layer would do
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+  device->AggregateObject (ndqi);
+  ndqi->CreateTxQueues ();
+  return device;
+}
+
+void
+TxFlowControlTestCase::DoRun (void)
+{
+  // A frame larger than the whole queue is dropped on an empty queue,
+  // which no dequeue would ever wake again
+  Ptr<PointToPointNetDevice> device = Build ("500B");
+  Ptr<NetDeviceQueue> txq = device->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  NS_TEST_ASSERT_MSG_EQ (device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x0800), false,
+                         "frame larger than the queue");
+  NS_TEST_ASSERT_MSG_EQ (txq->IsStopped (), false, "empty queue left running");
+  Simulator::Destroy ();
+
+  // One frame on the wire, two queued, one dropped: stopped until the
+  // queue drains
+  device = Build ("2p");
+  txq = device->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x0800);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txq->IsStopped (), true, "full queue stopped");
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (device->GetQueue ()->IsEmpty (), true, "queue drained");
+  NS_TEST_ASSERT_MSG_EQ (txq->IsStopped (), false, "drained queue woken");
+  Simulator::Destroy ();
+}
+
+/**
+ * \param buffer where to read
+ * \param bytes the size of the value in bytes
+ * \return the little-endian value at buffer
+ */
+static uint64_t
+ReadLittleEndian (const uint8_t *buffer, uint32_t bytes)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < bytes; i++)
+    {
+      value |= uint64_t (buffer[i]) << (8 * i);
+    }
+  return value;
+}
+
+/**
+ * Check that binary link traces read back with the documented layout.
+ */
+class BinaryTraceTestCase : public TestCase
+{
+public:
+  BinaryTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Hand packets to a device
+   * \param device the device
+   * \param n the number of packets
+   */
+  void Send (Ptr<PointToPointNetDevice> device, uint32_t n);
+};
+
+BinaryTraceTestCase::BinaryTraceTestCase ()
+  : TestCase ("Binary link trace round trip")
+{
+}
+
+void
+BinaryTraceTestCase::Send (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x0800);
+    }
+}
+
+void
+BinaryTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("binary-trace.btr");
+  {
+    NodeContainer nodes;
+    nodes.Create (2);
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+    p2p.SetDeviceAttribute ("Compression", BooleanValue (true));
+    p2p.SetBinaryTrace (true);
+    Config::SetGlobal ("CompressionConfigJson", StringValue ("{\"protocolsToCompress\": \"0x0021\"}"));
+    NetDeviceContainer devices = p2p.Install (nodes);
+    p2p.EnableAscii (filename, devices.Get (0), true);
+    Simulator::Schedule (Seconds (0), &BinaryTraceTestCase::Send, this,
+                         devices.Get (0)->GetObject<PointToPointNetDevice> (), 3);
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  std::vector<uint8_t> data ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+  // Three enqueues and three dequeues on the sending device
+  NS_TEST_ASSERT_MSG_EQ (data.size (), 16 + 6 * 36, "header and six records");
+  NS_TEST_ASSERT_MSG_EQ (std::string (data.begin (), data.begin () + 8), std::string ("P2PBTRC\0", 8), "magic");
+  NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (&data[8], 4), 1, "version");
+  NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (&data[12], 4), 36, "record size");
+
+  // The frames are compressed before they are queued, so the records have
+  // the uids of the compressed frames
+  const char events[] = { '+', '-', '+', '+', '-', '-' };
+  const uint32_t frames[] = { 0, 0, 1, 2, 1, 2 };
+  uint64_t uids[3];
+  int64_t last = 0;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      const uint8_t *record = &data[16 + i * 36];
+      int64_t time = ReadLittleEndian (record, 8);
+      NS_TEST_ASSERT_MSG_EQ (record[32], events[i], "event of record " << i);
+      uint64_t uid = ReadLittleEndian (record + 8, 8);
+      if (events[i] == '+')
+        {
+          uids[frames[i]] = uid;
+        }
+      NS_TEST_ASSERT_MSG_EQ (uid, uids[frames[i]], "uid of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (record + 16, 4), 0, "node of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (record + 28, 2), 0, "device of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (record + 30, 2), 0x0021, "protocol of record " << i);
+      // PPP header and 1000 zeros, deflated
+      NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (record + 24, 4), 1002, "original size of record " << i);
+      NS_TEST_ASSERT_MSG_LT (ReadLittleEndian (record + 20, 4), 100, "wire size of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record[33], 1, "compressed flag of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (record + 34, 2), 0, "reserved bytes of record " << i);
+      NS_TEST_ASSERT_MSG_EQ ((time >= last), true, "time order of record " << i);
+      last = time;
+    }
+  NS_TEST_ASSERT_MSG_NE (uids[0], uids[1], "uids of frames 0 and 1");
+  NS_TEST_ASSERT_MSG_NE (uids[1], uids[2], "uids of frames 1 and 2");
+  NS_TEST_ASSERT_MSG_EQ (ReadLittleEndian (&data[16 + 2 * 36], 8), 0, "enqueued at the start");
+  NS_TEST_ASSERT_MSG_GT (ReadLittleEndian (&data[16 + 5 * 36], 8), 0, "dequeued once the link is free");
+}
+
+/**
+ * A transmit stage recording what it sees, for TxPipelineTestCase
+ */
+class RecordingTxStage : public PointToPointTxStage
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual bool Process (PointToPointTxContext &context);
+
+  /// What a stage saw of a packet
+  struct Record
+  {
+    std::string name;     //!< Name of the stage
+    uint32_t size;        //!< Size of the packet
+    uint16_t pppProtocol; //!< PPP protocol of the context
+  };
+  static std::vector<Record> g_records; //!< Everything the stages saw, in order
+
+private:
+  std::string m_name; //!< Name of the stage
+  bool m_drop;        //!< Stop the pipeline
+};
+
+std::vector<RecordingTxStage::Record> RecordingTxStage::g_records;
+
+NS_OBJECT_ENSURE_REGISTERED (RecordingTxStage);
+
+TypeId
+RecordingTxStage::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("RecordingTxStage")
+    .SetParent<PointToPointTxStage> ()
+    .AddConstructor<RecordingTxStage> ()
+    .AddAttribute ("Name", "Name of the stage in the records",
+                   StringValue (""),
+                   MakeStringAccessor (&RecordingTxStage::m_name),
+                   MakeStringChecker ())
+    .AddAttribute ("Drop", "Stop the pipeline",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RecordingTxStage::m_drop),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+bool
+RecordingTxStage::Process (PointToPointTxContext &context)
+{
+  Record record = { m_name, context.packet->GetSize (), context.pppProtocol };
+  g_records.push_back (record);
+  return !m_drop;
+}
+
+/**
+ * Check that stages added through the helper run right after the device's
+ * own stage at their position, in the order they were added.
+ */
+class TxPipelineTestCase : public TestCase
+{
+public:
+  TxPipelineTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TxPipelineTestCase::TxPipelineTestCase ()
+  : TestCase ("Transmit pipeline stages")
+{
+}
+
+void
+TxPipelineTestCase::DoRun (void)
+{
+  RecordingTxStage::g_records.clear ();
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("Compression", BooleanValue (true));
+  // Added out of pipeline order
+  p2p.AddTxStage (PointToPointTxStage::FRAME, "RecordingTxStage", "Name", StringValue ("frame"));
+  p2p.AddTxStage (PointToPointTxStage::CLASSIFY, "RecordingTxStage", "Name", StringValue ("classify"));
+  p2p.AddTxStage (PointToPointTxStage::PAYLOAD_COMPRESS, "RecordingTxStage", "Name", StringValue ("payload"));
+  p2p.AddTxStage (PointToPointTxStage::HEADER_COMPRESS, "RecordingTxStage", "Name", StringValue ("header"));
+  p2p.AddTxStage (PointToPointTxStage::FRAME, "RecordingTxStage", "Name", StringValue ("frame 2"),
+                  "Drop", BooleanValue (true));
+  Config::SetGlobal ("CompressionConfigJson", StringValue ("{\"protocolsToCompress\": \"0x0021\"}"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  Ptr<PointToPointNetDevice> device = devices.Get (0)->GetObject<PointToPointNetDevice> ();
+
+  NS_TEST_ASSERT_MSG_EQ (device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x0800), false,
+                         "the last stage drops the packet");
+  NS_TEST_ASSERT_MSG_EQ (device->GetQueue ()->IsEmpty (), true, "nothing enqueued after a drop");
+  Simulator::Destroy ();
+
+  const std::vector<RecordingTxStage::Record> &records = RecordingTxStage::g_records;
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 5, "every stage ran once");
+  NS_TEST_ASSERT_MSG_EQ (records[0].name, "classify", "first stage");
+  NS_TEST_ASSERT_MSG_EQ (records[0].size, 1000, "classified packet");
+  NS_TEST_ASSERT_MSG_EQ (records[0].pppProtocol, 0x0021, "protocol set by the device's classify stage");
+  NS_TEST_ASSERT_MSG_EQ (records[1].name, "header", "second stage");
+  NS_TEST_ASSERT_MSG_EQ (records[1].size, 1000, "packet before deflate");
+  NS_TEST_ASSERT_MSG_EQ (records[2].name, "payload", "third stage");
+  NS_TEST_ASSERT_MSG_LT (records[2].size, 1000, "packet deflated by the device's payload compress stage");
+  NS_TEST_ASSERT_MSG_EQ (records[2].pppProtocol, 0x4021, "protocol of a compressed packet");
+  NS_TEST_ASSERT_MSG_EQ (records[3].name, "frame", "fourth stage");
+  NS_TEST_ASSERT_MSG_EQ (records[3].size, records[2].size + 2, "PPP header added by the device's frame stage");
+  NS_TEST_ASSERT_MSG_EQ (records[4].name, "frame 2", "stages at one position in insertion order");
+  RecordingTxStage::g_records.clear ();
+}
+
+/**
+ * An object with a counted trace source, for CountedTraceTestCase
+ */
+class CountedTraceSource : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  CountedTracedCallback<Ptr<const Packet> > m_trace; //!< The trace source
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CountedTraceSource);
+
+TypeId
+CountedTraceSource::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("CountedTraceSource")
+    .SetParent<Object> ()
+    .AddConstructor<CountedTraceSource> ()
+    .AddTraceSource ("Trace", "A counted trace source",
+                     MakeTraceSourceAccessor (&CountedTraceSource::m_trace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+/**
+ * Check that counted trace sources know when a sink is connected, and that
+ * the device copies received frames for its traces only then.
+ */
+class CountedTraceTestCase : public TestCase
+{
+public:
+  CountedTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a packet seen by a trace
+   * \param packet the packet
+   */
+  void Traced (Ptr<const Packet> packet);
+  /**
+   * Record the packet PhyRxEnd sees, which is the packet the device
+   * passes up
+   * \param packet the packet
+   */
+  void PhyRxEnd (Ptr<const Packet> packet);
+  /**
+   * Record a packet the device passes up
+   * \param device the device
+   * \param packet the packet
+   * \param protocol its protocol
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  std::vector<Ptr<const Packet> > m_traced;   //!< Packets seen by the trace
+  std::vector<Ptr<const Packet> > m_arrived;  //!< Packets seen by PhyRxEnd
+  std::vector<uint32_t> m_receivedSizes;      //!< Sizes of the packets passed up
+};
+
+CountedTraceTestCase::CountedTraceTestCase ()
+  : TestCase ("Counted trace sources")
+{
+}
+
+void
+CountedTraceTestCase::Traced (Ptr<const Packet> packet)
+{
+  m_traced.push_back (packet);
+}
+
+void
+CountedTraceTestCase::PhyRxEnd (Ptr<const Packet> packet)
+{
+  m_arrived.push_back (packet);
+}
+
+bool
+CountedTraceTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_receivedSizes.push_back (packet->GetSize ());
+  return true;
+}
+
+void
+CountedTraceTestCase::DoRun (void)
+{
+  Ptr<CountedTraceSource> source = CreateObject<CountedTraceSource> ();
+  Callback<void, Ptr<const Packet> > sink = MakeCallback (&CountedTraceTestCase::Traced, this);
+  NS_TEST_ASSERT_MSG_EQ (source->m_trace.IsEmpty (), true, "no sink yet");
+  source->TraceConnectWithoutContext ("Trace", sink);
+  source->TraceConnect ("Trace", "context", MakeCallback (&CountedTraceTestCase::Traced, this));
+  NS_TEST_ASSERT_MSG_EQ (source->m_trace.IsEmpty (), false, "sinks connected through the accessor");
+  source->TraceDisconnectWithoutContext ("Trace", sink);
+  NS_TEST_ASSERT_MSG_EQ (source->m_trace.IsEmpty (), false, "one sink left");
+  source->TraceDisconnect ("Trace", "context", MakeCallback (&CountedTraceTestCase::Traced, this));
+  NS_TEST_ASSERT_MSG_EQ (source->m_trace.IsEmpty (), true, "every sink disconnected");
+  // The documented blind spot: the base class does not count
+  static_cast<TracedCallback<Ptr<const Packet> > &> (source->m_trace).ConnectWithoutContext (sink);
+  NS_TEST_ASSERT_MSG_EQ (source->m_trace.IsEmpty (), true, "connection through the base class");
+
+  // Without a MacRx sink the device passes up the packet that arrived; with
+  // one, MacRx gets a copy that keeps the PPP header
+  for (uint32_t traced = 0; traced < 2; traced++)
+    {
+      m_traced.clear ();
+      m_arrived.clear ();
+      m_receivedSizes.clear ();
+      NodeContainer nodes;
+      nodes.Create (2);
+      PointToPointHelper p2p;
+      NetDeviceContainer devices = p2p.Install (nodes);
+      Ptr<NetDevice> rx = devices.Get (1);
+      rx->SetReceiveCallback (MakeCallback (&CountedTraceTestCase::Receive, this));
+      rx->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&CountedTraceTestCase::PhyRxEnd, this));
+      if (traced)
+        {
+          rx->TraceConnectWithoutContext ("MacRx", MakeCallback (&CountedTraceTestCase::Traced, this));
+        }
+      devices.Get (0)->Send (Create<Packet> (100), rx->GetAddress (), 0x0800);
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      NS_TEST_ASSERT_MSG_EQ (m_arrived.size (), 1, "frame arrived");
+      NS_TEST_ASSERT_MSG_EQ (m_receivedSizes.size (), 1, "packet passed up");
+      NS_TEST_ASSERT_MSG_EQ (m_receivedSizes[0], 100, "PPP header removed");
+      NS_TEST_ASSERT_MSG_EQ (m_traced.size (), traced, "MacRx calls");
+      if (traced)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_traced[0]->GetSize (), 102, "MacRx sees the whole frame");
+          NS_TEST_ASSERT_MSG_NE (m_traced[0], m_arrived[0], "MacRx sees a copy");
+        }
+      else
+        {
+          // The frame lost its header in place, so nothing was copied
+          NS_TEST_ASSERT_MSG_EQ (m_arrived[0]->GetSize (), 100, "frame stripped in place");
+        }
+    }
+}
+
+/**
+ * Check that with History a frame lost on the link makes the receiver drop
+ * the frames that follow it until the next history reset, that a frame
+ * dropped by the sender's full queue makes the sender reset the history
+ * with its next frame, and that the frames after a reset are inflated
+ * correctly.
+ */
+class HistoryDesyncTestCase : public TestCase
+{
+public:
+  HistoryDesyncTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Hand packets to a device, each filled with its index
+   * \param device the device
+   * \param first the index of the first packet
+   * \param n the number of packets
+   */
+  void Send (Ptr<NetDevice> device, uint32_t first, uint32_t n);
+  /**
+   * Record a packet the device passes up
+   * \param device the device
+   * \param packet the packet
+   * \param protocol its protocol
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  /**
+   * Record a frame dropped because the history is out of sync
+   * \param frame the frame
+   */
+  void DesyncDrop (Ptr<const Packet> frame);
+  /**
+   * Record a frame dropped by the transmit queue
+   * \param frame the frame
+   */
+  void MacTxDrop (Ptr<const Packet> frame);
+
+  std::vector<uint32_t> m_received; //!< Fill byte of each packet passed up, or 256 if it is corrupt
+  uint32_t m_desyncDrops;           //!< DesyncDrop calls
+  uint32_t m_macTxDrops;            //!< MacTxDrop calls
+};
+
+HistoryDesyncTestCase::HistoryDesyncTestCase ()
+  : TestCase ("History resynchronizes after a lost frame"),
+    m_desyncDrops (0),
+    m_macTxDrops (0)
+{
+}
+
+void
+HistoryDesyncTestCase::Send (Ptr<NetDevice> device, uint32_t first, uint32_t n)
+{
+  for (uint32_t i = first; i < first + n; i++)
+    {
+      std::vector<uint8_t> data (1000, i);
+      device->Send (Create<Packet> (&data[0], data.size ()), device->GetBroadcast (), 0x0800);
+    }
+}
+
+bool
+HistoryDesyncTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  std::vector<uint8_t> data (packet->GetSize ());
+  packet->CopyData (&data[0], data.size ());
+  bool intact = protocol == 0x0800 && data.size () == 1000
+    && std::count (data.begin (), data.end (), data[0]) == 1000;
+  m_received.push_back (intact ? data[0] : 256);
+  return true;
+}
+
+void
+HistoryDesyncTestCase::DesyncDrop (Ptr<const Packet> frame)
+{
+  m_desyncDrops++;
+}
+
+void
+HistoryDesyncTestCase::MacTxDrop (Ptr<const Packet> frame)
+{
+  m_macTxDrops++;
+}
+
+void
+HistoryDesyncTestCase::DoRun (void)
+{
+  Config::SetGlobal ("CompressionConfigJson", StringValue ("{\"protocolsToCompress\": \"0x0021\"}"));
+  for (uint32_t queueDrop = 0; queueDrop < 2; queueDrop++)
+    {
+      m_received.clear ();
+      m_desyncDrops = 0;
+      m_macTxDrops = 0;
+      NodeContainer nodes;
+      nodes.Create (2);
+      PointToPointHelper p2p;
+      p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+      p2p.SetDeviceAttribute ("Compression", BooleanValue (true));
+      p2p.SetDeviceAttribute ("History", BooleanValue (true));
+      p2p.SetDeviceAttribute ("ResetRequest", BooleanValue (false));
+      if (queueDrop)
+        {
+          // No periodic resets: only the sender noticing its drops can
+          // resynchronize the receiver
+          p2p.SetQueue ("ns3::DropTailQueue<Packet>", "MaxSize", StringValue ("1p"));
+        }
+      else
+        {
+          // Frames 0, 4 and 8 start a new history; only they
+          // resynchronize the receiver
+          p2p.SetDeviceAttribute ("FlushInterval", UintegerValue (4));
+        }
+      NetDeviceContainer devices = p2p.Install (nodes);
+      Ptr<NetDevice> rx = devices.Get (1);
+      rx->SetReceiveCallback (MakeCallback (&HistoryDesyncTestCase::Receive, this));
+      rx->TraceConnectWithoutContext ("DesyncDrop", MakeCallback (&HistoryDesyncTestCase::DesyncDrop, this));
+      devices.Get (0)->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&HistoryDesyncTestCase::MacTxDrop, this));
+
+      std::vector<uint32_t> expected;
+      if (queueDrop)
+        {
+          // Frame 0 goes on the wire, frame 1 waits in the queue and
+          // frames 2 to 9 are dropped; frame 10 starts a new history
+          Simulator::Schedule (Seconds (0), &HistoryDesyncTestCase::Send, this, devices.Get (0), 0, 10);
+          Simulator::Schedule (Seconds (1), &HistoryDesyncTestCase::Send, this, devices.Get (0), 10, 2);
+          expected.push_back (0);
+          expected.push_back (1);
+          expected.push_back (10);
+          expected.push_back (11);
+        }
+      else
+        {
+          // Lose frame 1 on the link; frames 2 and 3 arrive intact but
+          // follow the lost frame
+          Ptr<ReceiveListErrorModel> errors = CreateObject<ReceiveListErrorModel> ();
+          std::list<uint32_t> lost;
+          lost.push_back (1);
+          errors->SetList (lost);
+          rx->SetAttribute ("ReceiveErrorModel", PointerValue (errors));
+          Simulator::Schedule (Seconds (0), &HistoryDesyncTestCase::Send, this, devices.Get (0), 0, 10);
+          expected.push_back (0);
+          for (uint32_t i = 4; i < 10; i++)
+            {
+              expected.push_back (i);
+            }
+        }
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      uint32_t macTxDrops = queueDrop ? 8 : 0;
+      uint32_t desyncDrops = queueDrop ? 0 : 2;
+      NS_TEST_ASSERT_MSG_EQ (m_macTxDrops, macTxDrops, "frames dropped by the transmit queue");
+      NS_TEST_ASSERT_MSG_EQ (m_desyncDrops, desyncDrops, "DesyncDrop calls");
+      NS_TEST_ASSERT_MSG_EQ ((m_received == expected), true, "frames passed up intact");
+    }
+}
+
+/**
+ * \brief Build a trace record that tells its index
+ * \param index the index of the record
+ * \param size the size of the record
+ * \return the record, index followed by bytes counting up from it
+ */
+static std::vector<uint8_t>
+MakeRecord (uint32_t index, uint32_t size)
+{
+  std::vector<uint8_t> record (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      record[i] = static_cast<uint8_t> (index + i);
+    }
+  return record;
+}
+
+/**
+ * Check that the asynchronous trace writer writes every record, in order,
+ * across many blocks, and that with DropWhenFull it drops whole records
+ * once no block is free.
+ */
+class TraceWriterTestCase : public TestCase
+{
+public:
+  TraceWriterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TraceWriterTestCase::TraceWriterTestCase ()
+  : TestCase ("Asynchronous trace writer")
+{
+}
+
+void
+TraceWriterTestCase::DoRun (void)
+{
+  // Records of 1 to 50 bytes, and one larger than a block
+  std::string filename = CreateTempDirFilename ("trace-writer.bin");
+  std::vector<uint8_t> expected;
+  Ptr<PointToPointTraceWriter> writer = CreateObjectWithAttributes<PointToPointTraceWriter> (
+      "BlockSize", UintegerValue (4096), "Blocks", UintegerValue (2));
+  writer->Open (filename);
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      std::vector<uint8_t> record = MakeRecord (i, i == 1000 ? 5000 : i % 50 + 1);
+      writer->Write (&record[0], record.size ());
+      expected.insert (expected.end (), record.begin (), record.end ());
+    }
+  writer->Close ();
+  NS_TEST_ASSERT_MSG_EQ (writer->GetDrops (), 0, "nothing dropped while waiting for free blocks");
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  std::vector<uint8_t> data ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+  NS_TEST_ASSERT_MSG_EQ (data.size (), expected.size (), "file size");
+  NS_TEST_ASSERT_MSG_EQ ((data == expected), true, "file contents");
+  uint8_t late = 0;
+  writer->Write (&late, 1);
+  NS_TEST_ASSERT_MSG_EQ (writer->GetDrops (), 1, "records after Close are dropped");
+
+  // Write into a pipe nobody reads yet: the writer thread blocks on the
+  // first block, which is larger than the pipe buffer, so once the second
+  // block is full there is no free block left
+  std::string fifo = CreateTempDirFilename ("trace-writer.fifo");
+  NS_TEST_ASSERT_MSG_EQ (mkfifo (fifo.c_str (), 0600), 0, "mkfifo " << fifo);
+  int fd = open (fifo.c_str (), O_RDONLY | O_NONBLOCK);
+  NS_TEST_ASSERT_MSG_NE (fd, -1, "open " << fifo);
+  fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) & ~O_NONBLOCK);
+  writer = CreateObjectWithAttributes<PointToPointTraceWriter> (
+      "BlockSize", UintegerValue (131072), "Blocks", UintegerValue (2),
+      "DropWhenFull", BooleanValue (true));
+  writer->Open (fifo);
+  // 131 records of 1000 bytes fit in a block
+  expected.clear ();
+  for (uint32_t i = 0; i < 400; i++)
+    {
+      std::vector<uint8_t> record = MakeRecord (i, 1000);
+      writer->Write (&record[0], record.size ());
+      if (i < 2 * 131)
+        {
+          expected.insert (expected.end (), record.begin (), record.end ());
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (writer->GetDrops (), 400 - 2 * 131, "records dropped with both blocks in use");
+
+  data.clear ();
+  std::thread reader ([fd, &data] ()
+    {
+      uint8_t buffer[4096];
+      ssize_t n;
+      while ((n = read (fd, buffer, sizeof (buffer))) > 0)
+        {
+          data.insert (data.end (), buffer, buffer + n);
+        }
+    });
+  writer->Close ();
+  reader.join ();
+  close (fd);
+  NS_TEST_ASSERT_MSG_EQ (data.size (), expected.size (), "bytes written");
+  NS_TEST_ASSERT_MSG_EQ ((data == expected), true, "the records before the drops are written whole");
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that the channel delivers each packet in flight once, in arrival
+ * order, when a shorter Delay makes one overtake another, and none once
+ * it is disposed.
+ */
+class ChannelInFlightTestCase : public TestCase
+{
+public:
+  ChannelInFlightTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Hand a packet to a device
+   * \param device the device
+   * \param size the size of the packet
+   */
+  void Send (Ptr<NetDevice> device, uint32_t size);
+  /**
+   * Record a packet the device passes up
+   * \param device the device
+   * \param packet the packet
+   * \param protocol its protocol
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  std::vector<uint32_t> m_receivedSizes; //!< Sizes of the packets passed up
+  std::vector<Time> m_receivedTimes;     //!< When they were passed up
+};
+
+ChannelInFlightTestCase::ChannelInFlightTestCase ()
+  : TestCase ("Point-to-point channel packets in flight")
+{
+}
+
+void
+ChannelInFlightTestCase::Send (Ptr<NetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x0800);
+}
+
+bool
+ChannelInFlightTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_receivedSizes.push_back (packet->GetSize ());
+  m_receivedTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+ChannelInFlightTestCase::DoRun (void)
+{
+  for (uint32_t dispose = 0; dispose < 2; dispose++)
+    {
+      m_receivedSizes.clear ();
+      m_receivedTimes.clear ();
+      NodeContainer nodes;
+      nodes.Create (2);
+      PointToPointHelper p2p;
+      p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+      p2p.SetChannelAttribute ("Delay", StringValue ("10ms"));
+      NetDeviceContainer devices = p2p.Install (nodes);
+      devices.Get (1)->SetReceiveCallback (MakeCallback (&ChannelInFlightTestCase::Receive, this));
+      Ptr<Channel> channel = devices.Get (0)->GetChannel ();
+
+      // A 100 byte packet is on the wire by 0.102ms and arrives at 10.102ms
+      Simulator::Schedule (Seconds (0), &ChannelInFlightTestCase::Send, this, devices.Get (0), 100);
+      if (dispose)
+        {
+          Simulator::Schedule (MilliSeconds (2), &ChannelInFlightTestCase::Send, this, devices.Get (0), 200);
+          Simulator::Schedule (MilliSeconds (5), &Channel::Dispose, channel);
+        }
+      else
+        {
+          // A 200 byte packet sent at 2ms over 1ms of delay arrives at
+          // 3.202ms, first; the event armed for the 100 byte one goes stale
+          Simulator::Schedule (MilliSeconds (1), &Channel::SetAttribute, channel,
+                               std::string ("Delay"), TimeValue (MilliSeconds (1)));
+          Simulator::Schedule (MilliSeconds (2), &ChannelInFlightTestCase::Send, this, devices.Get (0), 200);
+        }
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      if (dispose)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_receivedSizes.size (), 0, "nothing delivered after the channel is disposed");
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_receivedSizes.size (), 2, "each packet delivered once");
+      NS_TEST_ASSERT_MSG_EQ (m_receivedSizes[0], 200, "the overtaking packet first");
+      NS_TEST_ASSERT_MSG_EQ (m_receivedTimes[0], MicroSeconds (3202), "arrival of the overtaking packet");
+      NS_TEST_ASSERT_MSG_EQ (m_receivedSizes[1], 100, "the overtaken packet second");
+      NS_TEST_ASSERT_MSG_EQ (m_receivedTimes[1], MicroSeconds (10102), "arrival of the overtaken packet");
+    }
+}
+
+/**
+ * Check that each flow of a MultiFlowClient starts on time, sends its
+ * number of packets, and spaces them by its rate.
+ */
+class MultiFlowClientTestCase : public TestCase
+{
+public:
+  MultiFlowClientTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the time of a packet sent by a flow
+   * \param packet the packet
+   * \param flow the index of the flow
+   */
+  void Tx (Ptr<const Packet> packet, uint32_t flow);
+
+  std::vector<Time> m_sendTimes[3]; //!< Times the packets of each flow were sent
+};
+
+MultiFlowClientTestCase::MultiFlowClientTestCase ()
+  : TestCase ("Multi-flow client packet counts and intervals")
+{
+}
+
+void
+MultiFlowClientTestCase::Tx (Ptr<const Packet> packet, uint32_t flow)
+{
+  NS_TEST_ASSERT_MSG_LT (flow, 3, "flow index");
+  SendTimeTag tag;
+  NS_TEST_ASSERT_MSG_EQ (packet->PeekPacketTag (tag), true, "send time tag");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetSendTime (), Simulator::Now (), "send time of the tag");
+  m_sendTimes[flow].push_back (Simulator::Now ());
+}
+
+void
+MultiFlowClientTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper stack;
+  stack.Install (node);
+
+  // Every flow sends a packet every 100ms
+  Address remote = InetSocketAddress (Ipv4Address::GetLoopback (), 9);
+  Ptr<MultiFlowClient> client = CreateObject<MultiFlowClient> ();
+  client->AddFlow (remote, CreateObjectWithAttributes<ConstantRandomVariable> ("Constant", DoubleValue (1000)),
+                   DataRate ("80kbps"), 5);
+  client->AddFlow (remote, CreateObjectWithAttributes<ConstantRandomVariable> ("Constant", DoubleValue (500)),
+                   DataRate ("40kbps"), 0, MilliSeconds (50));
+  client->AddFlow (remote, CreateObjectWithAttributes<ConstantRandomVariable> ("Constant", DoubleValue (100)),
+                   DataRate ("8kbps"), 3, MilliSeconds (250), false);
+  NS_TEST_ASSERT_MSG_EQ (client->GetNFlows (), 3, "flows added");
+  client->TraceConnectWithoutContext ("Tx", MakeCallback (&MultiFlowClientTestCase::Tx, this));
+  node->AddApplication (client);
+  client->SetStartTime (Seconds (0));
+  client->SetStopTime (Seconds (1));
+
+  Simulator::Run ();
+
+  // The flow without a limit sends until the application stops
+  const uint32_t packets[] = { 5, 10, 3 };
+  const Time starts[] = { Seconds (0), MilliSeconds (50), MilliSeconds (250) };
+  for (uint32_t flow = 0; flow < 3; flow++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (client->GetSent (flow), packets[flow], "packets sent by flow " << flow);
+      NS_TEST_ASSERT_MSG_EQ (m_sendTimes[flow].size (), packets[flow], "packets traced for flow " << flow);
+      NS_TEST_ASSERT_MSG_EQ (m_sendTimes[flow][0], starts[flow], "start of flow " << flow);
+      for (uint32_t i = 1; i < m_sendTimes[flow].size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_sendTimes[flow][i] - m_sendTimes[flow][i - 1], MilliSeconds (100),
+                                 "interval before packet " << i << " of flow " << flow);
+        }
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that a compressed frame cut right after its compression header is
+ * dropped as a codec error instead of being inflated.
+ */
+class TruncatedFrameTestCase : public TestCase
+{
+public:
+  TruncatedFrameTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a frame dropped by the device
+   * \param frame the frame
+   */
+  void PhyRxDrop (Ptr<const Packet> frame);
+  /**
+   * Record the codec error count
+   * \param oldValue the previous count
+   * \param newValue the new count
+   */
+  void CodecErrors (uint64_t oldValue, uint64_t newValue);
+  /**
+   * Record a packet the device passes up
+   * \param device the device
+   * \param packet the packet
+   * \param protocol its protocol
+   * \param from the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  uint32_t m_drops;       //!< PhyRxDrop calls
+  uint64_t m_codecErrors; //!< Last CodecErrors value
+  uint32_t m_received;    //!< Packets passed up
+};
+
+TruncatedFrameTestCase::TruncatedFrameTestCase ()
+  : TestCase ("Compressed frame without a payload"),
+    m_drops (0),
+    m_codecErrors (0),
+    m_received (0)
+{
+}
+
+void
+TruncatedFrameTestCase::PhyRxDrop (Ptr<const Packet> frame)
+{
+  m_drops++;
+}
+
+void
+TruncatedFrameTestCase::CodecErrors (uint64_t oldValue, uint64_t newValue)
+{
+  m_codecErrors = newValue;
+}
+
+bool
+TruncatedFrameTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+TruncatedFrameTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("Compression", BooleanValue (true));
+  Config::SetGlobal ("CompressionConfigJson", StringValue ("{\"protocolsToCompress\": \"0x0021\"}"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  Ptr<PointToPointNetDevice> rx = devices.Get (1)->GetObject<PointToPointNetDevice> ();
+  rx->SetReceiveCallback (MakeCallback (&TruncatedFrameTestCase::Receive, this));
+  rx->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&TruncatedFrameTestCase::PhyRxDrop, this));
+  rx->TraceConnectWithoutContext ("CodecErrors", MakeCallback (&TruncatedFrameTestCase::CodecErrors, this));
+
+  Ptr<Packet> frame = Create<Packet> ();
+  CompressionHeader compression;
+  compression.SetProtocol (0x0021);
+  compression.SetOriginalSize (1000);
+  frame->AddHeader (compression);
+  PppHeader ppp;
+  ppp.SetProtocol (0x4021);
+  frame->AddHeader (ppp);
+  rx->Receive (frame);
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 1, "frame dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_codecErrors, 1, "counted as a codec error");
+  NS_TEST_ASSERT_MSG_EQ (m_received, 0, "nothing passed up");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +1733,23 @@ Project1TestSuite::Project1TestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new Project1TestCase1, TestCase::QUICK);
+  AddTestCase (new CompressionIntegrityTestCase, TestCase::QUICK);
+  AddTestCase (new PayloadGeneratorTestCase, TestCase::QUICK);
+  AddTestCase (new TimerWheelTestCase, TestCase::QUICK);
+  AddTestCase (new PcapReplayTestCase, TestCase::QUICK);
+  AddTestCase (new TokenBucketTestCase, TestCase::QUICK);
+  AddTestCase (new SendTimeTagTestCase, TestCase::QUICK);
+  AddTestCase (new TxBurstTestCase, TestCase::QUICK);
+  AddTestCase (new CompressionFlowProbeTestCase, TestCase::QUICK);
+  AddTestCase (new TxFlowControlTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceTestCase, TestCase::QUICK);
+  AddTestCase (new TxPipelineTestCase, TestCase::QUICK);
+  AddTestCase (new CountedTraceTestCase, TestCase::QUICK);
+  AddTestCase (new HistoryDesyncTestCase, TestCase::QUICK);
+  AddTestCase (new TraceWriterTestCase, TestCase::QUICK);
+  AddTestCase (new ChannelInFlightTestCase, TestCase::QUICK);
+  AddTestCase (new MultiFlowClientTestCase, TestCase::QUICK);
+  AddTestCase (new TruncatedFrameTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite